@@ -0,0 +1,491 @@
+// Microbenchmarks of the simulator's hot paths. Every benchmark is run for a
+// range of grid sizes and obstacle densities, and the results are written as
+// JSON, so that runs before and after a change can be compared by a script.
+//
+// Usage: robot_mapping_simulator_benchmarks [-output FILE] [-filter TEXT]
+//                                           [-min-time SECONDS]
+//
+// Heap allocations are counted too (see memory_counter.h). The steady state
+// benchmarks step runs of a world the algorithm has mapped before, so every
+// buffer has already grown to its size, and fail if such a step allocates.
+// The fleet checks fail if a fleet of robots does not finish mapping a world.
+
+// Includes
+#include "application.h"
+#include "algorithms/fast_deterministic_algorithm.h"
+#include "algorithms/helper_functions.h"
+#include "memory_counter.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Local types
+struct BenchmarkOptions {
+    std::string output_file;
+    std::string filter;
+    double min_time;
+};
+
+// A world a fleet must finish mapping, with the seed of its obstacles
+struct FleetWorld {
+    int grid_size;
+    int obstacle_amount;
+    int robot_amount;
+    int sensor_range;
+    unsigned long long seed;
+};
+
+struct BenchmarkResult {
+    std::string name;
+    int grid_size;
+    double obstacle_density;
+    long long operation_amount;
+    double median_nanoseconds;
+    double minimum_nanoseconds;
+    double maximum_nanoseconds;
+    double allocations_per_operation;
+};
+
+// The body of a benchmark performs the given amount of operations
+typedef std::function<void(long long)> BenchmarkBody;
+
+// Global constants
+const int GRID_SIZES[] = {32, 128, 512};
+const double OBSTACLE_DENSITIES[] = {0.05, 0.2};
+const char* ALGORITHM_NAMES[] = {"random", "no_backtrack_random", "fast_deterministic",
+                                 "fast_deterministic_incremental", "fast_deterministic_hierarchical",
+                                 "fast_deterministic_distance_field"};
+const int REPETITION_AMOUNT = 5;
+// Amount of precomputed random poses the pose based benchmarks cycle through
+const int POSE_AMOUNT = 1024;
+// Runs of the step benchmarks are restarted after this many steps, so that the
+// cost of a step does not depend on how long the benchmark runs
+const int MAX_RUN_STEPS = 10000;
+const char* STEADY_STATE_PREFIX = "steady_step/";
+// The lidar of the scan benchmark
+const int LIDAR_RANGE = 16;
+const int LIDAR_RAY_AMOUNT = 360;
+const unsigned long long SEED = 1;
+// Fleets that once got stuck, whose robots kept blocking each other or kept
+// driving into a robot that had stopped
+const FleetWorld FLEET_WORLDS[] = {{100, 1500, 3, 5, 5}, {50, 700, 4, 1, 1}, {50, 700, 4, 1, 7},
+                                   {50, 700, 4, 1, 11}, {40, 400, 8, 1, 7}, {40, 448, 4, 1, 3},
+                                   {40, 448, 4, 1, 10}, {50, 625, 8, 1, 12}};
+const char* FLEET_ALGORITHM_NAMES[] = {"fast_deterministic", "fast_deterministic_incremental",
+                                       "fast_deterministic_hierarchical", "fast_deterministic_distance_field"};
+const int MAX_FLEET_ITERATIONS = 100000;
+const char* FLEET_CHECK_PREFIX = "fleet_check/";
+
+// Written to by the benchmarks so that their work is not optimized away
+static volatile long long g_sink;
+
+// Local function prototypes
+static bool parse_arguments(int argc, char* argv[], BenchmarkOptions&);
+static void run_benchmarks(const BenchmarkOptions&, std::vector<BenchmarkResult>&);
+static void run_benchmark(const BenchmarkOptions&, const std::string& name, int grid_size,
+                          double obstacle_density, const std::function<BenchmarkBody()>& setup,
+                          std::vector<BenchmarkResult>&);
+static double time_body(const BenchmarkBody&, long long operation_amount);
+static Parameters make_parameters(int grid_size, double obstacle_density, const std::string& algorithm);
+static std::vector<Pose> generate_poses(Application&);
+static void write_results(std::ostream&, const BenchmarkOptions&, const std::vector<BenchmarkResult>&);
+static bool check_steady_state(const std::vector<BenchmarkResult>&);
+static bool check_fleets(const BenchmarkOptions&);
+
+int main(int argc, char* argv[])
+{
+    BenchmarkOptions options = {"", "", 0.5};
+    if (!parse_arguments(argc, argv, options)) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [-output FILE] [-filter TEXT] [-min-time SECONDS]" << std::endl;
+        return 1;
+    }
+
+    std::vector<BenchmarkResult> results;
+    run_benchmarks(options, results);
+
+    if (options.output_file.empty()) {
+        write_results(std::cout, options, results);
+    } else {
+        std::ofstream file(options.output_file);
+        if (!file) {
+            std::cerr << "Could not open " << options.output_file << "." << std::endl;
+            return 1;
+        }
+        write_results(file, options, results);
+    }
+    bool is_steady_state_allocation_free = check_steady_state(results);
+    bool do_fleets_finish = check_fleets(options);
+    return is_steady_state_allocation_free && do_fleets_finish ? 0 : 1;
+}
+
+bool parse_arguments(int argc, char* argv[], BenchmarkOptions& options)
+{
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            return false;
+        } else if (strcmp(argv[i], "-output") == 0) {
+            options.output_file = argv[++i];
+        } else if (strcmp(argv[i], "-filter") == 0) {
+            options.filter = argv[++i];
+        } else if (strcmp(argv[i], "-min-time") == 0) {
+            options.min_time = atof(argv[++i]);
+            if (options.min_time <= 0) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+void run_benchmarks(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results)
+{
+    for (int grid_size : GRID_SIZES) {
+        for (double obstacle_density : OBSTACLE_DENSITIES) {
+            Parameters parameters = make_parameters(grid_size, obstacle_density, "random");
+
+            run_benchmark(options, "generate_random_obstacles", grid_size, obstacle_density, [=]() {
+                std::shared_ptr<Application> app(new Application(parameters));
+                return BenchmarkBody([=](long long operation_amount) {
+                    for (long long i = 0; i < operation_amount; i++) {
+                        app->generate_random_obstacles();
+                    }
+                    g_sink = app->get_obstacles().size();
+                });
+            }, results);
+
+            run_benchmark(options, "read_sensor", grid_size, obstacle_density, [=]() {
+                std::shared_ptr<Application> app(new Application(parameters));
+                app->generate_random_obstacles();
+                std::vector<Pose> poses = generate_poses(*app);
+                return BenchmarkBody([=](long long operation_amount) {
+                    RobotServer& server = app->get_robot_server();
+                    long long obstacle_amount = 0;
+                    for (long long i = 0; i < operation_amount; i++) {
+                        const Pose& pose = poses[i % POSE_AMOUNT];
+                        app->set_robot_position(pose.position);
+                        app->set_robot_orientation(pose.orientation);
+                        SensorData data = server.read_sensor();
+                        obstacle_amount += data.left + data.front + data.right;
+                    }
+                    g_sink = obstacle_amount;
+                });
+            }, results);
+
+            // One operation is one scan of LIDAR_RAY_AMOUNT rays
+            run_benchmark(options, "read_scan/lidar", grid_size, obstacle_density, [=]() {
+                Parameters lidar_parameters = parameters;
+                lidar_parameters.sensor_model.type = SensorType::LIDAR;
+                lidar_parameters.sensor_model.range = LIDAR_RANGE;
+                lidar_parameters.sensor_model.ray_amount = LIDAR_RAY_AMOUNT;
+                std::shared_ptr<Application> app(new Application(lidar_parameters));
+                app->generate_random_obstacles();
+                std::vector<Pose> poses = generate_poses(*app);
+                return BenchmarkBody([=](long long operation_amount) {
+                    RobotServer& server = app->get_robot_server();
+                    long long cell_amount = 0;
+                    for (long long i = 0; i < operation_amount; i++) {
+                        const Pose& pose = poses[i % POSE_AMOUNT];
+                        app->set_robot_position(pose.position);
+                        app->set_robot_orientation(pose.orientation);
+                        const SensorScan& scan = server.read_scan();
+                        cell_amount += scan.free_cells.size() + scan.hit_cells.size();
+                    }
+                    g_sink = cell_amount;
+                });
+            }, results);
+
+            // Every obstacle is already known, as late in a run, so the
+            // vector does not grow and every sensed obstacle is searched for
+            run_benchmark(options, "add_newly_found_obstacles", grid_size, obstacle_density, [=]() {
+                Application app(parameters);
+                app.generate_random_obstacles();
+                std::vector<Pose> poses = generate_poses(app);
+                std::vector<SensorData> readings;
+                std::vector<Surroundings> surroundings;
+                for (const Pose& pose : poses) {
+                    app.set_robot_position(pose.position);
+                    app.set_robot_orientation(pose.orientation);
+                    readings.push_back(app.get_robot_server().read_sensor());
+                    surroundings.push_back(calculate_pose_surroundings(pose.position, pose.orientation));
+                }
+                std::shared_ptr<std::vector<Vector2>> found_obstacles(
+                    new std::vector<Vector2>(app.get_obstacles()));
+                return BenchmarkBody([=](long long operation_amount) {
+                    for (long long i = 0; i < operation_amount; i++) {
+                        add_newly_found_obstacles(*found_obstacles, readings[i % POSE_AMOUNT],
+                                                  surroundings[i % POSE_AMOUNT]);
+                    }
+                    g_sink = found_obstacles->size();
+                });
+            }, results);
+
+            // The planner benchmarks start from a partially explored map,
+            // made by letting the algorithm drive the robot for a while
+            std::function<std::shared_ptr<FastDeterministicAlgorithm>(Application&, Planner)> explore =
+                [=](Application& app, Planner planner) {
+                    std::shared_ptr<FastDeterministicAlgorithm> state(new FastDeterministicAlgorithm(planner));
+                    RobotServer& server = app.get_robot_server();
+                    app.generate_random_obstacles();
+                    for (int i = 0; i < grid_size * 8 && !app.has_stopped(); i++) {
+                        state->sense(server);
+                        state->plan(server);
+                        if (!app.has_stopped()) {
+                            state->act(server);
+                        }
+                    }
+                    return state;
+                };
+
+            run_benchmark(options, "calculate_next_pose", grid_size, obstacle_density, [=]() {
+                std::shared_ptr<Application> app(new Application(parameters));
+                std::shared_ptr<FastDeterministicAlgorithm> state = explore(*app, Planner::BEST_PATH);
+                return BenchmarkBody([=](long long operation_amount) {
+                    RobotServer& server = app->get_robot_server();
+                    long long sum = 0;
+                    for (long long i = 0; i < operation_amount; i++) {
+                        Pose pose = state->calculate_next_pose(server);
+                        sum += pose.position.x + pose.position.y;
+                    }
+                    g_sink = sum;
+                });
+            }, results);
+
+            run_benchmark(options, "calculate_best_path", grid_size, obstacle_density, [=]() {
+                std::shared_ptr<Application> app(new Application(parameters));
+                std::shared_ptr<FastDeterministicAlgorithm> state = explore(*app, Planner::BEST_PATH);
+                std::vector<Pose> goals = generate_poses(*app);
+                Pose start = {app->get_robot_position(), app->get_robot_orientation()};
+                std::shared_ptr<std::vector<Move>> moves(new std::vector<Move>());
+                return BenchmarkBody([=](long long operation_amount) {
+                    RobotServer& server = app->get_robot_server();
+                    long long sum = 0;
+                    for (long long i = 0; i < operation_amount; i++) {
+                        state->calculate_best_path(server, start, goals[i % POSE_AMOUNT], *moves);
+                        sum += moves->size();
+                    }
+                    g_sink = sum;
+                });
+            }, results);
+
+            // The same goals, only planned up to the hierarchical planner's
+            // waypoint
+            run_benchmark(options, "calculate_hierarchical_path", grid_size, obstacle_density, [=]() {
+                std::shared_ptr<Application> app(new Application(parameters));
+                std::shared_ptr<FastDeterministicAlgorithm> state = explore(*app, Planner::HIERARCHICAL);
+                std::vector<Pose> goals = generate_poses(*app);
+                Pose start = {app->get_robot_position(), app->get_robot_orientation()};
+                std::shared_ptr<std::vector<Move>> moves(new std::vector<Move>());
+                return BenchmarkBody([=](long long operation_amount) {
+                    RobotServer& server = app->get_robot_server();
+                    long long sum = 0;
+                    for (long long i = 0; i < operation_amount; i++) {
+                        state->calculate_hierarchical_path(server, start, goals[i % POSE_AMOUNT], *moves);
+                        sum += moves->size();
+                    }
+                    g_sink = sum;
+                });
+            }, results);
+
+            // One operation chooses the next pose and plans the path to it,
+            // the work of calculate_next_pose and calculate_best_path together
+            run_benchmark(options, "calculate_informative_path", grid_size, obstacle_density, [=]() {
+                std::shared_ptr<Application> app(new Application(parameters));
+                std::shared_ptr<FastDeterministicAlgorithm> state = explore(*app, Planner::DISTANCE_FIELD);
+                Pose start = {app->get_robot_position(), app->get_robot_orientation()};
+                std::shared_ptr<std::vector<Move>> moves(new std::vector<Move>());
+                return BenchmarkBody([=](long long operation_amount) {
+                    RobotServer& server = app->get_robot_server();
+                    long long sum = 0;
+                    for (long long i = 0; i < operation_amount; i++) {
+                        Pose pose = state->calculate_informative_path(server, start, *moves);
+                        sum += pose.position.x + moves->size();
+                    }
+                    g_sink = sum;
+                });
+            }, results);
+
+            // One operation is one step of a headless run
+            for (const char* algorithm : ALGORITHM_NAMES) {
+                Parameters run_parameters = make_parameters(grid_size, obstacle_density, algorithm);
+                std::string name = std::string("step_through/") + algorithm;
+                run_benchmark(options, name, grid_size, obstacle_density, [=]() {
+                    std::shared_ptr<Application> app(new Application(run_parameters));
+                    app->set_quiet(true);
+                    std::shared_ptr<unsigned long long> seed(new unsigned long long(SEED));
+                    app->restart(*seed);
+                    return BenchmarkBody([=](long long operation_amount) {
+                        for (long long i = 0; i < operation_amount; i++) {
+                            if (app->has_stopped() || app->get_number_of_iterations() >= MAX_RUN_STEPS) {
+                                app->restart(++*seed);
+                            }
+                            app->step_through();
+                        }
+                        g_sink = app->get_number_of_iterations();
+                    });
+                }, results);
+
+                // The world is the same on every restart and was mapped once
+                // before timing starts
+                name = STEADY_STATE_PREFIX + std::string(algorithm);
+                run_benchmark(options, name, grid_size, obstacle_density, [=]() {
+                    std::shared_ptr<Application> app(new Application(run_parameters));
+                    app->set_quiet(true);
+                    app->run_headless(MAX_RUN_STEPS);
+                    app->restart(SEED);
+                    return BenchmarkBody([=](long long operation_amount) {
+                        for (long long i = 0; i < operation_amount; i++) {
+                            if (app->has_stopped() || app->get_number_of_iterations() >= MAX_RUN_STEPS) {
+                                app->restart(SEED);
+                            }
+                            app->step_through();
+                        }
+                        g_sink = app->get_number_of_iterations();
+                    });
+                }, results);
+            }
+        }
+    }
+}
+
+void run_benchmark(const BenchmarkOptions& options, const std::string& name, int grid_size,
+                   double obstacle_density, const std::function<BenchmarkBody()>& setup,
+                   std::vector<BenchmarkResult>& results)
+{
+    if (name.find(options.filter) == std::string::npos) {
+        return;
+    }
+
+    BenchmarkBody body = setup();
+
+    // Double the amount of operations until one repetition takes long enough
+    // to be measured reliably
+    double repetition_time = options.min_time / REPETITION_AMOUNT;
+    long long operation_amount = 1;
+    while (time_body(body, operation_amount) < repetition_time) {
+        operation_amount *= 2;
+    }
+
+    std::vector<double> nanoseconds(REPETITION_AMOUNT);
+    long long start_allocation_amount = get_allocation_amount();
+    for (int i = 0; i < REPETITION_AMOUNT; i++) {
+        nanoseconds[i] = time_body(body, operation_amount) * 1e9 / operation_amount;
+    }
+    long long allocation_amount = get_allocation_amount() - start_allocation_amount;
+    std::sort(nanoseconds.begin(), nanoseconds.end());
+
+    BenchmarkResult result = {name, grid_size, obstacle_density, operation_amount,
+                              nanoseconds[REPETITION_AMOUNT / 2], nanoseconds.front(),
+                              nanoseconds.back(),
+                              static_cast<double>(allocation_amount) / (REPETITION_AMOUNT * operation_amount)};
+    results.push_back(result);
+
+    std::cerr << name << " " << grid_size << "x" << grid_size << " " << obstacle_density
+              << ": " << result.median_nanoseconds << " ns, " << result.allocations_per_operation
+              << " allocations" << std::endl;
+}
+
+double time_body(const BenchmarkBody& body, long long operation_amount)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    body(operation_amount);
+    std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+    return time.count();
+}
+
+Parameters make_parameters(int grid_size, double obstacle_density, const std::string& algorithm)
+{
+    Parameters parameters = {grid_size, grid_size,
+                             static_cast<int>(grid_size * grid_size * obstacle_density),
+                             algorithm, SEED, false, "", "", "", "", 1, {SensorType::BEAMS, 1, 360}};
+    return parameters;
+}
+
+std::vector<Pose> generate_poses(Application& app)
+{
+    RobotServer& server = app.get_robot_server();
+    std::vector<Pose> poses;
+    for (int i = 0; i < POSE_AMOUNT; i++) {
+        Pose pose;
+        pose.position.x = server.generate_random_number(app.get_grid_width());
+        pose.position.y = server.generate_random_number(app.get_grid_height());
+        pose.orientation = server.generate_random_number(4);
+        poses.push_back(pose);
+    }
+    return poses;
+}
+
+void write_results(std::ostream& stream, const BenchmarkOptions& options,
+                   const std::vector<BenchmarkResult>& results)
+{
+    stream << "{\n";
+    stream << "  \"context\": {\"min_time\": " << options.min_time
+           << ", \"repetitions\": " << REPETITION_AMOUNT << ", \"seed\": " << SEED << "},\n";
+    stream << "  \"benchmarks\": [";
+    for (int i = 0; i < results.size(); i++) {
+        const BenchmarkResult& result = results[i];
+        stream << (i == 0 ? "\n" : ",\n");
+        stream << "    {\"name\": \"" << result.name << "\""
+               << ", \"grid_size\": " << result.grid_size
+               << ", \"obstacle_density\": " << result.obstacle_density
+               << ", \"operations\": " << result.operation_amount
+               << ", \"median_ns\": " << result.median_nanoseconds
+               << ", \"min_ns\": " << result.minimum_nanoseconds
+               << ", \"max_ns\": " << result.maximum_nanoseconds
+               << ", \"allocations\": " << result.allocations_per_operation << "}";
+    }
+    stream << "\n  ]\n}\n";
+}
+
+bool check_steady_state(const std::vector<BenchmarkResult>& results)
+{
+    bool is_allocation_free = true;
+    for (const BenchmarkResult& result : results) {
+        if (result.name.compare(0, strlen(STEADY_STATE_PREFIX), STEADY_STATE_PREFIX) == 0 &&
+            result.allocations_per_operation > 0) {
+            std::cerr << result.name << " " << result.grid_size << "x" << result.grid_size << " "
+                      << result.obstacle_density << " allocates in its steady state." << std::endl;
+            is_allocation_free = false;
+        }
+    }
+    return is_allocation_free;
+}
+
+bool check_fleets(const BenchmarkOptions& options)
+{
+    bool do_fleets_finish = true;
+    for (const char* algorithm : FLEET_ALGORITHM_NAMES) {
+        std::string name = FLEET_CHECK_PREFIX + std::string(algorithm);
+        if (name.find(options.filter) == std::string::npos) {
+            continue;
+        }
+
+        for (const FleetWorld& world : FLEET_WORLDS) {
+            Parameters parameters = make_parameters(world.grid_size, 0, algorithm);
+            parameters.obstacle_amount = world.obstacle_amount;
+            parameters.robot_amount = world.robot_amount;
+            parameters.sensor_model.range = world.sensor_range;
+            parameters.seed = world.seed;
+
+            Application app(parameters);
+            app.set_quiet(true);
+            app.run_headless(MAX_FLEET_ITERATIONS);
+            if (!app.has_stopped()) {
+                std::cerr << name << " " << world.grid_size << "x" << world.grid_size << " seed "
+                          << world.seed << " has not finished after " << MAX_FLEET_ITERATIONS
+                          << " iterations." << std::endl;
+                do_fleets_finish = false;
+            }
+        }
+    }
+    return do_fleets_finish;
+}
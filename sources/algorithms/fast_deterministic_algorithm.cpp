@@ -1,207 +1,535 @@
-
 // Includes
 #include "fast_deterministic_algorithm.h"
-#include "helper_functions.h"
+#include <algorithm>
 #include <climits>
 #include <iostream>
-#include <stack>
-#include <vector>
 
 // Using namespace
 using namespace std;
 
-// Local types
-struct Pose {
-    Vector2 position;
-    int orientation;
-};
-
-struct AStarInfo {
-    Pose current_node;
-    int F;
-    int G;
-    int H;
-    Pose parent_node;
-};
-
-// Globals (local to this file)
-static vector<Vector2> gl_found_obstacles;
-static vector<Vector2> gl_previously_seen_spaces;
-static Move gl_next_move;
-static stack<Move> gl_move_list;
-static int gl_old_obstacle_amount;
-
 // Local function prototypes
-static void sense(RobotServer&);
-static void plan(RobotServer&);
-static void act(RobotServer&);
-static void plot(RobotServer&, Plotter&);
-static Pose calculate_next_pose(RobotServer&);
-static stack<Move> calculate_best_path(RobotServer&, Pose, Pose);
+static AlgorithmState* create_state();
+static AlgorithmState* create_incremental_state();
+static AlgorithmState* create_hierarchical_state();
+static AlgorithmState* create_distance_field_state();
 static int calculate_distance(Vector2, Vector2);
-static bool specialized_is_member(const vector<AStarInfo>&, Pose);
+static long long pose_to_index(Pose pose, int grid_width);
+static Pose index_to_pose(long long index, int grid_width);
+static int dstar_predecessors(long long index, int grid_width, int grid_height, long long predecessors[3]);
 
 void add_fast_deterministic_algorithm(Application& app)
 {
-    // Initialize globals
-    gl_old_obstacle_amount = 0;
+    // Add algorithm, once for every planner
+    app.add_algorithm("fast_deterministic", create_state,
+                      run_headless<FastDeterministicAlgorithm>);
+    app.add_algorithm("fast_deterministic_incremental", create_incremental_state,
+                      run_headless<FastDeterministicAlgorithm>);
+    app.add_algorithm("fast_deterministic_hierarchical", create_hierarchical_state,
+                      run_headless<FastDeterministicAlgorithm>);
+    app.add_algorithm("fast_deterministic_distance_field", create_distance_field_state,
+                      run_headless<FastDeterministicAlgorithm>);
+}
+
+AlgorithmState* create_state()
+{
+    return new FastDeterministicAlgorithm(Planner::BEST_PATH);
+}
+
+AlgorithmState* create_incremental_state()
+{
+    return new FastDeterministicAlgorithm(Planner::INCREMENTAL);
+}
 
-    // Add algorithm
-    app.add_algorithm("fast_deterministic", sense, plan, act, plot);
+AlgorithmState* create_hierarchical_state()
+{
+    return new FastDeterministicAlgorithm(Planner::HIERARCHICAL);
 }
 
-void sense(RobotServer& server)
+AlgorithmState* create_distance_field_state()
 {
-    SensorData data = server.read_sensor();
-    Surroundings surroundings = calculate_robot_surroundings(server);
+    return new FastDeterministicAlgorithm(Planner::DISTANCE_FIELD);
+}
 
-    add_newly_found_obstacles(gl_found_obstacles, data, surroundings);
+FastDeterministicAlgorithm::FastDeterministicAlgorithm(Planner planner)
+    : m_planner(planner), m_current_search_stamp(0), m_dstar_stamp(0)
+{
+    reset();
+}
 
-    // Add to previously seen positions
-    if (!is_member(gl_previously_seen_spaces, surroundings.front)) {
-        gl_previously_seen_spaces.push_back(surroundings.front);
+void FastDeterministicAlgorithm::reset()
+{
+    // Keep the allocated maps and node data, they are reinitialized by the
+    // first sense of the run. The search stamps keep counting so that node
+    // data of the previous run is never mistaken for current data.
+    m_move_list.clear();
+    m_found_obstacle_grid.reset(0, 0);
+    m_old_obstacle_amount = 0;
+    m_plotted_obstacle_amount = 0;
+    m_new_seen_spaces.clear();
+    m_has_path_changed = false;
+    m_goal_index = -1;
+    m_was_blocked = false;
+    m_is_path_blocked = false;
+    m_dstar_goal_index = -1;
+    m_replan_amount = 0;
+    m_avoided_replan_amount = 0;
+    m_expanded_node_amount = 0;
+    m_maximum_expanded_node_amount = 0;
+    m_abstract_expanded_node_amount = 0;
+}
+
+void FastDeterministicAlgorithm::sense(RobotServer& server)
+{
+    const SensorScan& scan = server.read_scan();
+
+    int grid_width = server.get_grid_width();
+    int grid_height = server.get_grid_height();
+
+    if (m_found_obstacle_grid.get_width() != grid_width ||
+        m_found_obstacle_grid.get_height() != grid_height) {
+        reset_maps(grid_width, grid_height);
     }
-    if (!is_member(gl_previously_seen_spaces, surroundings.left)) {
-        gl_previously_seen_spaces.push_back(surroundings.left);
+
+    // Add newly found obstacles
+    for (Vector2 obstacle : scan.hit_cells) {
+        if (!m_found_obstacle_grid.is_occupied(obstacle)) {
+            add_found_obstacle(obstacle, grid_width);
+        }
     }
-    if (!is_member(gl_previously_seen_spaces, surroundings.right)) {
-        gl_previously_seen_spaces.push_back(surroundings.right);
+
+    // Add to previously seen positions, which include the found obstacles
+    for (Vector2 space : scan.free_cells) {
+        add_seen_space(space, grid_width, grid_height);
+    }
+    for (Vector2 space : scan.hit_cells) {
+        add_seen_space(space, grid_width, grid_height);
     }
-    if (!is_member(gl_previously_seen_spaces, server.get_position())) {
-        gl_previously_seen_spaces.push_back(server.get_position());
+    add_seen_space(server.get_position(), grid_width, grid_height);
+
+    // Robots of a fleet share their maps through what they have plotted,
+    // which includes what this robot has plotted itself
+    if (server.get_robot_amount() > 1) {
+        const vector<Vector2>& plotted_obstacles = server.get_plotted_obstacles();
+        for (; m_fleet_obstacle_amount < plotted_obstacles.size(); m_fleet_obstacle_amount++) {
+            Vector2 obstacle = plotted_obstacles[m_fleet_obstacle_amount];
+            if (!m_found_obstacle_grid.is_occupied(obstacle)) {
+                add_found_obstacle(obstacle, grid_width);
+            }
+        }
+
+        const vector<Vector2>& plotted_seen_spaces = server.get_plotted_seen_spaces();
+        for (; m_fleet_seen_space_amount < plotted_seen_spaces.size(); m_fleet_seen_space_amount++) {
+            add_seen_space(plotted_seen_spaces[m_fleet_seen_space_amount], grid_width, grid_height);
+        }
     }
 
     // Stop server if you have found all obstacles
-    if (gl_found_obstacles.size() == server.get_obstacle_amount()) {
+    if (m_found_obstacles.size() == server.get_obstacle_amount()) {
         server.stop();
     }
 }
 
-void plan(RobotServer& server)
+void FastDeterministicAlgorithm::plan(RobotServer& server)
 {
-    if (gl_move_list.empty() || gl_found_obstacles.size() > gl_old_obstacle_amount) {
-        Pose next_pose = calculate_next_pose(server);
+    // New obstacles only matter if they block the rest of the path, which
+    // sense has already checked, or make the goal worthless
+    bool is_goal_uninformative = m_goal_index != -1 && m_information_values.get(m_goal_index) == 0;
+    bool is_goal_seen_by_fleet = server.get_robot_amount() > 1 && m_goal_index != -1 &&
+                                 m_information_values.get(m_goal_index) < m_goal_information_value;
 
+    if (m_move_list.empty() || m_is_path_blocked || is_goal_uninformative || is_goal_seen_by_fleet) {
         Pose current_pose;
         current_pose.position = server.get_position();
         current_pose.orientation = server.get_orientation();
 
-        gl_move_list = calculate_best_path(server, current_pose, next_pose);
-        gl_old_obstacle_amount = gl_found_obstacles.size();
+        // The distance field chooses the pose in the same search as the path
+        Pose next_pose = current_pose;
+        if (m_planner != Planner::DISTANCE_FIELD) {
+            next_pose = calculate_next_pose(server);
+        }
+
+        if (m_was_blocked) {
+            // Plan around the robot in the way. D* Lite only knows lasting
+            // obstacles, so the incremental planner uses A* for this path and
+            // repairs its own search from wherever the detour has led.
+            m_found_obstacle_grid.set_occupied(m_blocked_position, true);
+            if (m_planner == Planner::DISTANCE_FIELD) {
+                next_pose = calculate_informative_path(server, current_pose, m_move_list);
+            } else {
+                calculate_best_path(server, current_pose, next_pose, m_move_list);
+            }
+            m_found_obstacle_grid.set_occupied(m_blocked_position, false);
+        } else if (m_planner == Planner::INCREMENTAL) {
+            // Keep the goal of the previous search while it is still as
+            // informative as the best pose, since only then can the previous
+            // search be repaired instead of thrown away
+            if (m_dstar_goal_index != -1 &&
+                m_dstar_nodes.size() == static_cast<long long>(server.get_grid_width()) * server.get_grid_height() * 4) {
+                Pose goal = index_to_pose(m_dstar_goal_index, server.get_grid_width());
+                if (calculate_information_value(goal) == calculate_information_value(next_pose)) {
+                    next_pose = goal;
+                }
+            }
+            calculate_incremental_path(server, current_pose, next_pose, m_move_list);
+        } else if (m_planner == Planner::HIERARCHICAL) {
+            calculate_hierarchical_path(server, current_pose, next_pose, m_move_list);
+        } else if (m_planner == Planner::DISTANCE_FIELD) {
+            next_pose = calculate_informative_path(server, current_pose, m_move_list);
+        } else {
+            calculate_best_path(server, current_pose, next_pose, m_move_list);
+        }
+
+        // Robots blocking each other with no way around, as in a corridor,
+        // back off until one of them gets out of the way
+        if (m_was_blocked && m_move_list.empty()) {
+            back_off(server, current_pose);
+        }
+        m_goal_index = pose_to_index(next_pose, server.get_grid_width());
+        m_goal_information_value = m_information_values.get(m_goal_index);
+        m_was_blocked = false;
+        m_is_path_blocked = false;
+        mark_path_cells(current_pose);
+        m_has_path_changed = true;
+    } else if (m_found_obstacles.size() > m_old_obstacle_amount) {
+        m_avoided_replan_amount++;
     }
+    m_old_obstacle_amount = m_found_obstacles.size();
 
     // If the newly generated path is empty, stop the simulation
-    if (gl_move_list.empty()) {
+    if (m_move_list.empty()) {
         server.stop();
     } else {
-        gl_next_move = gl_move_list.top();
-        gl_move_list.pop();
+        m_next_move = m_move_list.back();
+        m_move_list.pop_back();
     }
 }
 
-void act(RobotServer& server)
+// Turns to a random free cell next to the robot, other than the one of the
+// robot in the way, and drives into it. Turning in place would only face the
+// robot in the way again on the next plan. If every cell around the robot is
+// known to be taken, a random turn is all that is left.
+void FastDeterministicAlgorithm::back_off(RobotServer& server, Pose pose)
 {
-    perform_move(server, gl_next_move);
+    int free_turn_amounts[3];
+    int free_amount = 0;
+    for (int turn_amount = 1; turn_amount < 4; turn_amount++) {
+        Vector2 cell = calculate_pose_surroundings(pose.position, (pose.orientation + turn_amount) % 4).front;
+        if (m_found_obstacle_grid.is_in_bounds(cell) && !m_found_obstacle_grid.is_occupied(cell)) {
+            free_turn_amounts[free_amount] = turn_amount;
+            free_amount++;
+        }
+    }
+
+    m_move_list.clear();
+    if (free_amount == 0) {
+        Move moves[2] = {Move::TURN_LEFT, Move::TURN_RIGHT};
+        m_move_list.push_back(moves[server.generate_random_number(2)]);
+        return;
+    }
+
+    // The moves are added last first
+    int turn_amount = free_turn_amounts[server.generate_random_number(free_amount)];
+    m_move_list.push_back(Move::MOVE_FORWARD);
+    if (turn_amount == 3) {
+        m_move_list.push_back(Move::TURN_RIGHT);
+    } else {
+        for (int i = 0; i < turn_amount; i++) {
+            m_move_list.push_back(Move::TURN_LEFT);
+        }
+    }
 }
 
-void plot(RobotServer& server, Plotter& plotter)
+void FastDeterministicAlgorithm::act(RobotServer& server)
 {
-    plotter.plot(gl_found_obstacles);
+    Vector2 position = server.get_position();
+    perform_move(server, m_next_move);
+
+    // Only another robot can block a planned move, after which the rest of
+    // the moves start from the wrong pose
+    if (m_next_move == Move::MOVE_FORWARD && server.get_position() == position) {
+        m_was_blocked = true;
+        m_blocked_position = calculate_pose_surroundings(position, server.get_orientation()).front;
+        m_move_list.clear();
+    }
 }
 
-Pose calculate_next_pose(RobotServer& server)
+void FastDeterministicAlgorithm::plot(RobotServer& server, Plotter& plotter)
 {
-    Pose pose = {{0, 0}, 0};
-    int minimum_distance = INT_MAX;
-    int maximum_information_value = INT_MIN;
+    for (int i = m_plotted_obstacle_amount; i < m_found_obstacles.size(); i++) {
+        plotter.plot_obstacle(m_found_obstacles[i]);
+    }
+    m_plotted_obstacle_amount = m_found_obstacles.size();
 
-    for (int x = 0; x < server.get_grid_width(); x++) {
-        for (int y = 0; y < server.get_grid_height(); y++) {
-            for (int orientation = 0; orientation < 4; orientation++) {
-                Pose p = {{x, y}, orientation};
-                int information_value;
-
-                if (is_member(gl_found_obstacles, p.position)) {
-                    information_value = 0;
-                } else {
-                    Surroundings p_surroundings = calculate_pose_surroundings(p.position, p.orientation);
-                    information_value = 3;
-                    if (is_member(gl_previously_seen_spaces, p_surroundings.left)) {
-                        information_value--;
-                    }
-                    if (is_member(gl_previously_seen_spaces, p_surroundings.front)) {
-                        information_value--;
-                    }
-                    if (is_member(gl_previously_seen_spaces, p_surroundings.right)) {
-                        information_value--;
-                    }
-                }
+    for (Vector2 space : m_new_seen_spaces) {
+        plotter.plot_seen_space(space);
+    }
+    m_new_seen_spaces.clear();
+
+    // Follow the rest of the moves from where the robot is now
+    if (m_has_path_changed) {
+        Vector2 position = server.get_position();
+        int orientation = server.get_orientation();
+
+        m_path.clear();
+        m_path.push_back(position);
+        for (int i = m_move_list.size() - 1; i >= 0; i--) {
+            if (m_move_list[i] == Move::MOVE_FORWARD) {
+                position = calculate_pose_surroundings(position, orientation).front;
+                m_path.push_back(position);
+            } else if (m_move_list[i] == Move::TURN_LEFT) {
+                orientation = (orientation + 1) % 4;
+            } else {
+                orientation = (orientation + 3) % 4;
+            }
+        }
+
+        plotter.plot_path(m_path);
+        m_has_path_changed = false;
+    }
+}
+
+void FastDeterministicAlgorithm::report(ostream& out)
+{
+    out << "Number of replans: " << m_replan_amount << endl;
+    out << "Avoided replans: " << m_avoided_replan_amount << endl;
+    out << "Expanded nodes: " << m_expanded_node_amount << " total, ";
+    if (m_replan_amount > 0) {
+        out << m_expanded_node_amount / m_replan_amount << " per replan, ";
+    }
+    out << m_maximum_expanded_node_amount << " at most" << endl;
+    if (m_planner == Planner::HIERARCHICAL) {
+        out << "Expanded abstract nodes: " << m_abstract_expanded_node_amount << endl;
+    }
+}
+
+void FastDeterministicAlgorithm::count_replan(long long expanded_node_amount)
+{
+    m_replan_amount++;
+    m_expanded_node_amount += expanded_node_amount;
+    m_maximum_expanded_node_amount = max(m_maximum_expanded_node_amount, expanded_node_amount);
+}
 
-                int distance = calculate_distance(server.get_position(), p.position);
+void FastDeterministicAlgorithm::reset_maps(int grid_width, int grid_height)
+{
+    m_found_obstacles.clear();
+    m_fleet_obstacle_amount = 0;
+    m_fleet_seen_space_amount = 0;
+    m_found_obstacle_grid.reset(grid_width, grid_height);
+    m_seen_grid.reset(grid_width + 2, grid_height + 2);
+    m_path_grid.reset(grid_width, grid_height);
+    m_path_cells.clear();
+    if (m_planner == Planner::HIERARCHICAL) {
+        m_hierarchical_planner.reset(grid_width, grid_height);
+    }
+
+    // Nothing has been seen yet, so every pose can see three new spaces
+    m_information_values.assign(static_cast<long long>(grid_width) * grid_height * 4, 3);
+    m_information_value_amounts[0] = 0;
+    m_information_value_amounts[1] = 0;
+    m_information_value_amounts[2] = 0;
+    m_information_value_amounts[3] = m_information_values.size();
+}
+
+void FastDeterministicAlgorithm::add_found_obstacle(Vector2 obstacle, int grid_width)
+{
+    m_found_obstacles.push_back(obstacle);
+    m_found_obstacle_grid.set_occupied(obstacle, true);
+    if (m_path_grid.is_occupied(obstacle)) {
+        m_is_path_blocked = true;
+    }
+    if (m_planner == Planner::HIERARCHICAL) {
+        m_hierarchical_planner.add_obstacle(obstacle);
+    }
+
+    // Poses inside obstacles are worthless
+    for (int orientation = 0; orientation < 4; orientation++) {
+        Pose pose = {obstacle, orientation};
+        set_information_value(pose_to_index(pose, grid_width), 0);
+    }
+}
+
+// Marks the cells the planned moves drive through from the pose, after
+// unmarking those of the previous path. Cells the robot has already left stay
+// marked until the next path, which does no harm as they are known to be free.
+void FastDeterministicAlgorithm::mark_path_cells(Pose start)
+{
+    for (Vector2 cell : m_path_cells) {
+        m_path_grid.set_occupied(cell, false);
+    }
+    m_path_cells.clear();
+
+    Vector2 position = start.position;
+    int orientation = start.orientation;
+    for (int i = m_move_list.size() - 1; i >= 0; i--) {
+        if (m_move_list[i] == Move::MOVE_FORWARD) {
+            position = calculate_pose_surroundings(position, orientation).front;
+            m_path_grid.set_occupied(position, true);
+            m_path_cells.push_back(position);
+        } else if (m_move_list[i] == Move::TURN_LEFT) {
+            orientation = (orientation + 1) % 4;
+        } else {
+            orientation = (orientation + 3) % 4;
+        }
+    }
+}
 
-                if (information_value > maximum_information_value ||
-                        (information_value == maximum_information_value && distance < minimum_distance)) {
-                    pose = p;
-                    maximum_information_value = information_value;
-                    minimum_distance = distance;
+void FastDeterministicAlgorithm::add_seen_space(Vector2 space, int grid_width, int grid_height)
+{
+    Vector2 seen_grid_position = space + Vector2(1, 1);
+
+    if (m_seen_grid.is_in_bounds(seen_grid_position) && !m_seen_grid.is_occupied(seen_grid_position)) {
+        m_seen_grid.set_occupied(seen_grid_position, true);
+
+        // Spaces just outside the grid are plotted too, so that robots of a
+        // fleet do not go to see them again
+        m_new_seen_spaces.push_back(space);
+
+        // The space is in the surroundings of the poses next to it, except
+        // for those facing away from it
+        for (int direction = 0; direction < 4; direction++) {
+            Vector2 neighbour = calculate_pose_surroundings(space, (direction + 2) % 4).front;
+
+            if (neighbour.x >= 0 && neighbour.x < grid_width &&
+                neighbour.y >= 0 && neighbour.y < grid_height &&
+                !m_found_obstacle_grid.is_occupied(neighbour)) {
+                for (int orientation = 0; orientation < 4; orientation++) {
+                    if (orientation != (direction + 2) % 4) {
+                        Pose pose = {neighbour, orientation};
+                        long long index = pose_to_index(pose, grid_width);
+                        set_information_value(index, m_information_values.get(index) - 1);
+                    }
                 }
             }
         }
     }
+}
+
+void FastDeterministicAlgorithm::set_information_value(long long index, int information_value)
+{
+    m_information_value_amounts[m_information_values.get(index)]--;
+    m_information_values[index] = information_value;
+    m_information_value_amounts[information_value]++;
+}
+
+// Finds the most informative pose, breaking ties by distance to the robot.
+// The highest information value is known from the amounts, and the nearest
+// pose with that value is found by searching rings of increasing distance
+// around the robot.
+Pose FastDeterministicAlgorithm::calculate_next_pose(RobotServer& server)
+{
+    Vector2 position = server.get_position();
+    int grid_width = server.get_grid_width();
+    int grid_height = server.get_grid_height();
+
+    int maximum_information_value = 3;
+    while (maximum_information_value > 0 && m_information_value_amounts[maximum_information_value] == 0) {
+        maximum_information_value--;
+    }
 
     if (maximum_information_value <= 0) {
         server.stop();
+        Pose pose = {position, 0};
+        return pose;
+    }
+
+    int maximum_distance = max(position.x, grid_width - 1 - position.x) +
+                           max(position.y, grid_height - 1 - position.y);
+    Pose pose = {{0, 0}, 0};
+    bool found = false;
+
+    for (int distance = 0; distance <= maximum_distance && !found; distance++) {
+        // Walk the ring by increasing x and then y, so that the first pose
+        // found is the one with the lowest x, y and orientation
+        for (int dx = -distance; dx <= distance && !found; dx++) {
+            int dy = distance - abs(dx);
+            Vector2 ring_positions[2] = {position + Vector2(dx, -dy), position + Vector2(dx, dy)};
+            int ring_position_amount = dy == 0 ? 1 : 2;
+
+            for (int i = 0; i < ring_position_amount && !found; i++) {
+                Vector2 p = ring_positions[i];
+
+                if (p.x >= 0 && p.x < grid_width && p.y >= 0 && p.y < grid_height) {
+                    for (int orientation = 0; orientation < 4 && !found; orientation++) {
+                        Pose candidate = {p, orientation};
+                        if (m_information_values.get(pose_to_index(candidate, grid_width)) == maximum_information_value) {
+                            pose = candidate;
+                            found = true;
+                        }
+                    }
+                }
+            }
+        }
     }
 
     return pose;
 }
 
+int FastDeterministicAlgorithm::calculate_information_value(Pose pose)
+{
+    return m_information_values.get(pose_to_index(pose, m_found_obstacle_grid.get_width()));
+}
+
 int calculate_distance(Vector2 v1, Vector2 v2)
 {
     // Uses manhattan distance
     return abs(v1.x - v2.x) + abs(v1.y - v2.y);
 }
 
-stack<Move> calculate_best_path(RobotServer& server, Pose start, Pose end)
+long long pose_to_index(Pose pose, int grid_width)
 {
-    // FIXME: vector is not the right data structure for open list since
-    // random elements need to be deleted at any time
-    vector<AStarInfo> open_list;
+    return (static_cast<long long>(pose.position.y) * grid_width + pose.position.x) * 4 + pose.orientation;
+}
+
+Pose index_to_pose(long long index, int grid_width)
+{
+    Pose pose;
+    pose.orientation = index % 4;
+    pose.position.x = (index / 4) % grid_width;
+    pose.position.y = (index / 4) / grid_width;
+    return pose;
+}
+
+void FastDeterministicAlgorithm::calculate_best_path(RobotServer& server, Pose start, Pose end,
+                                                     vector<Move>& move_list)
+{
+    int grid_width = server.get_grid_width();
+    int grid_height = server.get_grid_height();
+    long long node_amount = static_cast<long long>(grid_width) * grid_height * 4;
 
-    vector<AStarInfo> closed_list;
+    start_search(node_amount);
 
     // Add start to open list
+    long long start_index = pose_to_index(start, grid_width);
+    long long end_index = pose_to_index(end, grid_width);
     int H = calculate_distance(start.position, end.position);
-    AStarInfo start_info = {start, H, 0, H, {{-1, -1}, 0}};
-    open_list.push_back(start_info);
-
-    // Add obstacles to closed list
-    for (int i = 0; i < gl_found_obstacles.size(); i++) {
-        for (int orientation = 0; orientation < 4; orientation++) {
-            Pose pose = {gl_found_obstacles[i], orientation};
-            AStarInfo info = {pose, 0, 0, 0, {{-1, -1}, 0}};
-            closed_list.push_back(info);
+    m_search_stamps[start_index] = m_current_search_stamp;
+    m_g_costs[start_index] = 0;
+    m_parents[start_index] = -1;
+    m_is_closed[start_index] = false;
+    m_open_list.clear();
+    m_open_list.push({H, H, start_index});
+
+    bool has_succeeded = false;
+    long long expanded_node_amount = 0;
+
+    while (!has_succeeded && !m_open_list.empty()) {
+        // Choose the node in the open list with the smallest F value
+        long long index = m_open_list.top().index;
+        m_open_list.pop();
+
+        // Skip stale entries of nodes that were already expanded
+        if (m_is_closed.get(index)) {
+            continue;
         }
-    }
-
-    bool has_failed = false;
+        m_is_closed[index] = true;
+        expanded_node_amount++;
 
-    while (!has_failed && !specialized_is_member(open_list, end)) {
-        if (open_list.empty()) {
-            has_failed = true;
+        if (index == end_index) {
+            has_succeeded = true;
         } else {
-            // Choose the node in the open list with the smallest F value
-            int minimum_F = INT_MAX;
-            int chosen_node_index = 0;
-            for (int i = 0; i < open_list.size(); i++) {
-                if (open_list[i].F < minimum_F) {
-                    minimum_F = open_list[i].F;
-                    chosen_node_index = i;
-                }
-            }
             // Expand the chosen node into three nodes
-            int G = open_list[chosen_node_index].G + 1;
-            Pose old_pose = open_list[chosen_node_index].current_node;
+            int G = m_g_costs.get(index) + 1;
+            Pose old_pose = index_to_pose(index, grid_width);
             Surroundings surroundings = calculate_pose_surroundings(old_pose.position, old_pose.orientation);
 
             Pose next_nodes[3] = {
@@ -213,69 +541,427 @@ stack<Move> calculate_best_path(RobotServer& server, Pose start, Pose end)
             for (int i = 0; i < 3; i++) {
                 Vector2 pos = next_nodes[i].position;
 
-                if (pos.x >= 0 && pos.x < server.get_grid_width() &&
-                    pos.y >= 0 && pos.y < server.get_grid_height() &&
-                    !is_member(gl_found_obstacles, pos)) {
+                if (pos.x >= 0 && pos.x < grid_width &&
+                    pos.y >= 0 && pos.y < grid_height &&
+                    !m_found_obstacle_grid.is_occupied(pos)) {
+
+                    long long next_index = pose_to_index(next_nodes[i], grid_width);
+                    bool is_new = m_search_stamps.get(next_index) != m_current_search_stamp;
 
-                    int H = calculate_distance(pos, end.position);
-                    AStarInfo info = {next_nodes[i], G + H, G, H, old_pose};
-                    open_list.push_back(info);
+                    if (is_new || (!m_is_closed.get(next_index) && G < m_g_costs.get(next_index))) {
+                        int H = calculate_distance(pos, end.position);
+                        m_search_stamps[next_index] = m_current_search_stamp;
+                        m_g_costs[next_index] = G;
+                        m_parents[next_index] = index;
+                        m_is_closed[next_index] = false;
+                        m_open_list.push({G + H, H, next_index});
+                    }
                 }
             }
-            // Put chosen node into closed list
-            closed_list.push_back(open_list[chosen_node_index]);
-            // Remove chosen node from open list
-            open_list.erase(open_list.begin() + chosen_node_index);
         }
     }
 
-    stack<Move> move_list;
+    count_replan(expanded_node_amount);
+
+    move_list.clear();
+
+    // If the algorithm never reached end node, return empty move list
+    if (has_succeeded) {
+        follow_parents(start_index, end_index, grid_width, move_list);
+    }
+}
+
+// Start a new search, clearing the node data only when the stamps wrap around
+// or the grid changed size
+void FastDeterministicAlgorithm::start_search(long long node_amount)
+{
+    m_current_search_stamp++;
+    if (m_search_stamps.size() != node_amount || m_current_search_stamp == 0) {
+        m_search_stamps.assign(node_amount, 0);
+        m_g_costs.assign(node_amount, 0);
+        m_parents.assign(node_amount, 0);
+        m_is_closed.assign(node_amount, false);
+        m_current_search_stamp = 1;
+    }
+}
+
+// Keeps adding moves to the move list until the start pose is reached by
+// following the parent links of the last search from the end pose
+void FastDeterministicAlgorithm::follow_parents(long long start_index, long long end_index, int grid_width,
+                                                vector<Move>& move_list)
+{
+    long long index = end_index;
+    while (index != start_index) {
+        Pose pose = index_to_pose(index, grid_width);
+        Pose parent = index_to_pose(m_parents.get(index), grid_width);
+
+        if (pose.position != parent.position) {
+            move_list.push_back(Move::MOVE_FORWARD);
+        } else if (pose.orientation == (parent.orientation + 1) % 4) {
+            move_list.push_back(Move::TURN_LEFT);
+        } else {
+            move_list.push_back(Move::TURN_RIGHT);
+        }
+
+        index = m_parents.get(index);
+    }
+}
+
+void FastDeterministicAlgorithm::calculate_hierarchical_path(RobotServer& server, Pose start, Pose end,
+                                                             vector<Move>& move_list)
+{
+    Pose waypoint;
+    bool has_path = m_hierarchical_planner.find_waypoint(m_found_obstacle_grid, start, end, waypoint);
+    m_abstract_expanded_node_amount += m_hierarchical_planner.get_expanded_node_amount();
+
+    if (has_path) {
+        calculate_best_path(server, start, waypoint, move_list);
+    } else {
+        count_replan(0);
+        move_list.clear();
+    }
+}
+
+// Every move costs the same, so a breadth-first search reaches the poses in
+// the order of their travel cost from the start. The search stops at the
+// first cost at which it has reached an informative pose, and goes to the
+// most informative pose of that cost, or at once if a pose has the highest
+// information value left on the map. Unlike calculate_next_pose this prefers
+// a near pose over a more informative one further away, which saves the
+// robot driving back and forth between them. The start itself is skipped,
+// since the robot has already sensed from it.
+Pose FastDeterministicAlgorithm::calculate_informative_path(RobotServer& server, Pose start,
+                                                            vector<Move>& move_list)
+{
+    int grid_width = server.get_grid_width();
+    int grid_height = server.get_grid_height();
+
+    start_search(static_cast<long long>(grid_width) * grid_height * 4);
+
+    int maximum_information_value = 3;
+    while (maximum_information_value > 0 && m_information_value_amounts[maximum_information_value] == 0) {
+        maximum_information_value--;
+    }
+
+    long long start_index = pose_to_index(start, grid_width);
+    long long best_index = start_index;
+    int best_information_value = 0;
+    m_search_stamps[start_index] = m_current_search_stamp;
+    m_g_costs[start_index] = 0;
+    m_parents[start_index] = -1;
+    m_field_queue.clear();
+    m_field_queue.push_back(start_index);
 
-    // If the algorithm never reached end node, return empty move list.
-    // Otherwise,
-    if (!has_failed) { 
-        // Find node info with end pose
-        AStarInfo* node_info = nullptr;
-        bool found = false;
-        for (int i = 0; i < open_list.size() && !found; i++) {
-            if (open_list[i].current_node.position == end.position && open_list[i].current_node.orientation == end.orientation) {
-                node_info = &open_list[i];
-                found = true;
+    long long expanded_node_amount = 0;
+
+    for (long long head = 0; head < m_field_queue.size() && maximum_information_value > 0; head++) {
+        long long index = m_field_queue[head];
+
+        // Every pose as near as the best one has been looked at
+        if (best_information_value > 0 && m_g_costs.get(index) > m_g_costs.get(best_index)) {
+            break;
+        }
+        expanded_node_amount++;
+
+        int information_value = m_information_values.get(index);
+        if (index != start_index && information_value > best_information_value) {
+            best_index = index;
+            best_information_value = information_value;
+            if (information_value == maximum_information_value) {
+                break;
             }
         }
 
-        // Keep adding moves to the move list until node info has start pose
-        while (node_info->current_node.position != start.position || node_info->current_node.orientation != start.orientation) {
-            if (node_info->current_node.position != node_info->parent_node.position) {
-                move_list.push(Move::MOVE_FORWARD);
-            } else if (node_info->current_node.orientation == (node_info->parent_node.orientation + 1) % 4) {
-                move_list.push(Move::TURN_LEFT);
-            } else {
-                move_list.push(Move::TURN_RIGHT);
+        Pose old_pose = index_to_pose(index, grid_width);
+        Surroundings surroundings = calculate_pose_surroundings(old_pose.position, old_pose.orientation);
+
+        Pose next_nodes[3] = {
+            {old_pose.position, (old_pose.orientation + 1) % 4}, // Left turn
+            {surroundings.front, old_pose.orientation}, // Move forward
+            {old_pose.position, (old_pose.orientation + 3) % 4}, // Right turn
+        };
+
+        for (int i = 0; i < 3; i++) {
+            Vector2 pos = next_nodes[i].position;
+
+            if (pos.x >= 0 && pos.x < grid_width &&
+                pos.y >= 0 && pos.y < grid_height &&
+                !m_found_obstacle_grid.is_occupied(pos)) {
+
+                long long next_index = pose_to_index(next_nodes[i], grid_width);
+                if (m_search_stamps.get(next_index) != m_current_search_stamp) {
+                    m_search_stamps[next_index] = m_current_search_stamp;
+                    m_g_costs[next_index] = m_g_costs.get(index) + 1;
+                    m_parents[next_index] = index;
+                    m_field_queue.push_back(next_index);
+                }
             }
+        }
+    }
+
+    count_replan(expanded_node_amount);
+
+    move_list.clear();
+    follow_parents(start_index, best_index, grid_width, move_list);
+    return index_to_pose(best_index, grid_width);
+}
 
-            // Find parent node in closed list
-            found = false;
-            for (int i = 0; i < closed_list.size() && !found; i++) {
-                if (closed_list[i].current_node.position == node_info->parent_node.position && closed_list[i].current_node.orientation == node_info->parent_node.orientation) {
-                    node_info = &closed_list[i];
-                    found = true;
+// The incremental planner is D* Lite (Koenig and Likhachev) over the same pose
+// graph as calculate_best_path. It searches backwards from the goal, so when
+// the robot moves or new obstacles are found only the affected nodes need to
+// be repaired, as long as the goal stays the same.
+void FastDeterministicAlgorithm::calculate_incremental_path(RobotServer& server, Pose start, Pose end,
+                                                            vector<Move>& move_list)
+{
+    int grid_width = server.get_grid_width();
+    int grid_height = server.get_grid_height();
+    long long node_amount = static_cast<long long>(grid_width) * grid_height * 4;
+    long long start_index = pose_to_index(start, grid_width);
+    long long end_index = pose_to_index(end, grid_width);
+
+    if (end_index != m_dstar_goal_index || m_dstar_nodes.size() != node_amount) {
+        // Start a new search towards the new goal
+        m_dstar_stamp++;
+        if (m_dstar_nodes.size() != node_amount || m_dstar_stamp == 0) {
+            DStarNode empty_node = {0, INFINITE_COST, INFINITE_COST, 0, 0, false};
+            m_dstar_nodes.assign(node_amount, empty_node);
+            m_dstar_stamp = 1;
+        }
+        m_dstar_open_list.clear();
+        m_dstar_goal_index = end_index;
+        m_dstar_last_start_index = start_index;
+        m_dstar_key_modifier = 0;
+        m_dstar_known_obstacle_amount = m_found_obstacles.size();
+
+        dstar_node(end_index).rhs = 0;
+        dstar_push(end_index, start.position, grid_width);
+    } else {
+        // The keys of the open list are relative to the start, so account
+        // for the robot having moved
+        Pose last_start = index_to_pose(m_dstar_last_start_index, grid_width);
+        m_dstar_key_modifier += calculate_distance(last_start.position, start.position);
+        m_dstar_last_start_index = start_index;
+
+        // Repair the nodes whose edges were changed by new obstacles
+        for (int i = m_dstar_known_obstacle_amount; i < m_found_obstacles.size(); i++) {
+            Vector2 obstacle = m_found_obstacles[i];
+            for (int orientation = 0; orientation < 4; orientation++) {
+                Pose pose = {obstacle, orientation};
+                long long index = pose_to_index(pose, grid_width);
+                long long predecessors[3];
+                int predecessor_amount = dstar_predecessors(index, grid_width, grid_height, predecessors);
+
+                dstar_update_node(index, start.position, grid_width, grid_height);
+                for (int j = 0; j < predecessor_amount; j++) {
+                    dstar_update_node(predecessors[j], start.position, grid_width, grid_height);
                 }
             }
         }
+        m_dstar_known_obstacle_amount = m_found_obstacles.size();
     }
 
-    return move_list;
+    count_replan(dstar_compute_shortest_path(start_index, grid_width, grid_height));
+
+    // Walk from the start to the goal by always taking the successor with the
+    // lowest cost to the goal, and reverse the moves at the end
+    move_list.clear();
+    long long index = start_index;
+    bool has_failed = dstar_node(start_index).g >= INFINITE_COST;
+
+    while (!has_failed && index != end_index) {
+        long long successors[3];
+        int successor_amount = dstar_successors(index, grid_width, grid_height, successors);
+        long long best_successor = -1;
+        int best_cost = INFINITE_COST;
+
+        for (int i = 0; i < successor_amount; i++) {
+            int cost = dstar_node(successors[i]).g;
+            if (cost < best_cost) {
+                best_cost = cost;
+                best_successor = successors[i];
+            }
+        }
+
+        if (best_successor == -1 || move_list.size() >= node_amount) {
+            has_failed = true;
+        } else {
+            Pose pose = index_to_pose(index, grid_width);
+            Pose next_pose = index_to_pose(best_successor, grid_width);
+
+            if (pose.position != next_pose.position) {
+                move_list.push_back(Move::MOVE_FORWARD);
+            } else if (next_pose.orientation == (pose.orientation + 1) % 4) {
+                move_list.push_back(Move::TURN_LEFT);
+            } else {
+                move_list.push_back(Move::TURN_RIGHT);
+            }
+            index = best_successor;
+        }
+    }
+
+    if (has_failed) {
+        move_list.clear();
+    } else {
+        reverse(move_list.begin(), move_list.end());
+    }
 }
 
-bool specialized_is_member(const vector<AStarInfo>& list, Pose pose)
+DStarNode& FastDeterministicAlgorithm::dstar_node(long long index)
 {
-    bool found = false;
-    for (int i = 0; i < list.size() && !found; i++) {
-        Pose this_pose = list[i].current_node;
-        if (this_pose.position == pose.position && this_pose.orientation == pose.orientation) {
-            found = true;
+    DStarNode& node = m_dstar_nodes[index];
+    // Nodes untouched by the current search are unexplored
+    if (node.stamp != m_dstar_stamp) {
+        node.stamp = m_dstar_stamp;
+        node.g = INFINITE_COST;
+        node.rhs = INFINITE_COST;
+        node.is_open = false;
+    }
+    return node;
+}
+
+// Inserts the node into the open list with its current key. Older entries of
+// the same node stay in the heap and are skipped once their key is outdated.
+void FastDeterministicAlgorithm::dstar_push(long long index, Vector2 start, int grid_width)
+{
+    DStarNode& node = dstar_node(index);
+    int cost = min(node.g, node.rhs);
+    Vector2 position = index_to_pose(index, grid_width).position;
+
+    node.key1 = cost + calculate_distance(start, position) + m_dstar_key_modifier;
+    node.key2 = cost;
+    node.is_open = true;
+    m_dstar_open_list.push({node.key1, node.key2, index});
+}
+
+void FastDeterministicAlgorithm::dstar_update_node(long long index, Vector2 start, int grid_width, int grid_height)
+{
+    DStarNode& node = dstar_node(index);
+
+    if (index != m_dstar_goal_index) {
+        long long successors[3];
+        int successor_amount = dstar_successors(index, grid_width, grid_height, successors);
+
+        node.rhs = INFINITE_COST;
+        for (int i = 0; i < successor_amount; i++) {
+            node.rhs = min(node.rhs, dstar_node(successors[i]).g + 1);
+        }
+    }
+
+    node.is_open = false;
+    if (node.g != node.rhs) {
+        dstar_push(index, start, grid_width);
+    }
+}
+
+// Fills the array with the poses reachable in one move and returns how many
+// there are. Poses inside found obstacles have no successors.
+int FastDeterministicAlgorithm::dstar_successors(long long index, int grid_width, int grid_height,
+                                                 long long successors[3])
+{
+    Pose pose = index_to_pose(index, grid_width);
+    int amount = 0;
+
+    if (!m_found_obstacle_grid.is_occupied(pose.position)) {
+        Pose left = {pose.position, (pose.orientation + 1) % 4};
+        Pose right = {pose.position, (pose.orientation + 3) % 4};
+        Pose front = {calculate_pose_surroundings(pose.position, pose.orientation).front, pose.orientation};
+
+        successors[amount++] = pose_to_index(left, grid_width);
+        if (front.position.x >= 0 && front.position.x < grid_width &&
+            front.position.y >= 0 && front.position.y < grid_height &&
+            !m_found_obstacle_grid.is_occupied(front.position)) {
+            successors[amount++] = pose_to_index(front, grid_width);
         }
+        successors[amount++] = pose_to_index(right, grid_width);
     }
-    return found;
+    return amount;
+}
+
+// Fills the array with the poses from which this pose could be reached in one
+// move if there were no obstacles and returns how many there are. Obstacles
+// are left out of this so that the poses whose edges were just blocked can
+// still be found.
+int dstar_predecessors(long long index, int grid_width, int grid_height, long long predecessors[3])
+{
+    Pose pose = index_to_pose(index, grid_width);
+    int amount = 0;
+
+    // Turning left from the orientation to the right and vice versa
+    Pose from_right = {pose.position, (pose.orientation + 3) % 4};
+    Pose from_left = {pose.position, (pose.orientation + 1) % 4};
+    Pose from_back = {calculate_pose_surroundings(pose.position, (pose.orientation + 2) % 4).front, pose.orientation};
+
+    predecessors[amount++] = pose_to_index(from_right, grid_width);
+    if (from_back.position.x >= 0 && from_back.position.x < grid_width &&
+        from_back.position.y >= 0 && from_back.position.y < grid_height) {
+        predecessors[amount++] = pose_to_index(from_back, grid_width);
+    }
+    predecessors[amount++] = pose_to_index(from_left, grid_width);
+    return amount;
+}
+
+// Expands nodes until the cost of the start is known and returns the amount of
+// expanded nodes
+long long FastDeterministicAlgorithm::dstar_compute_shortest_path(long long start_index, int grid_width,
+                                                                  int grid_height)
+{
+    Vector2 start = index_to_pose(start_index, grid_width).position;
+    long long expanded_node_amount = 0;
+    bool is_done = false;
+
+    while (!is_done) {
+        // Drop outdated entries from the top of the open list
+        while (!m_dstar_open_list.empty()) {
+            const DStarOpenNode& top = m_dstar_open_list.top();
+            const DStarNode& node = dstar_node(top.index);
+            if (node.is_open && node.key1 == top.key1 && node.key2 == top.key2) {
+                break;
+            }
+            m_dstar_open_list.pop();
+        }
+
+        DStarNode& start_node = dstar_node(start_index);
+        int start_cost = min(start_node.g, start_node.rhs);
+        DStarOpenNode start_key = {start_cost + m_dstar_key_modifier, start_cost, start_index};
+
+        if (m_dstar_open_list.empty() ||
+            (!(start_key > m_dstar_open_list.top()) && start_node.g == start_node.rhs)) {
+            is_done = true;
+        } else {
+            DStarOpenNode top = m_dstar_open_list.top();
+            m_dstar_open_list.pop();
+
+            DStarNode& node = dstar_node(top.index);
+            int cost = min(node.g, node.rhs);
+            Vector2 position = index_to_pose(top.index, grid_width).position;
+            DStarOpenNode new_key = {cost + calculate_distance(start, position) + m_dstar_key_modifier, cost, top.index};
+
+            long long predecessors[3];
+            int predecessor_amount = dstar_predecessors(top.index, grid_width, grid_height, predecessors);
+
+            if (new_key > top) {
+                // The key grew since the robot moved, so reinsert the node
+                dstar_push(top.index, start, grid_width);
+            } else if (node.g > node.rhs) {
+                // The node became cheaper, propagate to its predecessors
+                node.g = node.rhs;
+                node.is_open = false;
+                expanded_node_amount++;
+                for (int i = 0; i < predecessor_amount; i++) {
+                    dstar_update_node(predecessors[i], start, grid_width, grid_height);
+                }
+            } else {
+                // The node became more expensive, invalidate it and its
+                // predecessors
+                node.g = INFINITE_COST;
+                expanded_node_amount++;
+                dstar_update_node(top.index, start, grid_width, grid_height);
+                for (int i = 0; i < predecessor_amount; i++) {
+                    dstar_update_node(predecessors[i], start, grid_width, grid_height);
+                }
+            }
+        }
+    }
+
+    return expanded_node_amount;
 }
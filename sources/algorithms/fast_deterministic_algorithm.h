@@ -1,11 +1,181 @@
-
 // Begin header guard
 #ifndef FAST_DETERMINISTIC_ALGORITHM_H
 #define FAST_DETERMINISTIC_ALGORITHM_H
 
+// Includes
 #include "../application.h"
+#include "../min_heap.h"
+#include "../occupancy_grid.h"
+#include "../paged_array.h"
+#include "helper_functions.h"
+#include "hierarchical_planner.h"
+#include <climits>
+#include <ostream>
+#include <vector>
+
+// An entry of the A* open list. Nodes are referred to by their pose index
+// (see pose_to_index) so that all other per-node data can live in flat arrays.
+// Pose indices are 64-bit, since large worlds have more than 2^31 poses.
+struct OpenNode {
+    int F;
+    int H;
+    long long index;
+    bool operator>(const OpenNode& other) const
+    {
+        return F > other.F || (F == other.F && H > other.H);
+    }
+};
+
+// The node data of the incremental planner (D* Lite). g is the cost to the
+// goal of the last expansion and rhs the one-step lookahead cost; a node is
+// only open when the two differ.
+struct DStarNode {
+    unsigned int stamp;
+    int g;
+    int rhs;
+    int key1;
+    int key2;
+    bool is_open;
+};
+
+struct DStarOpenNode {
+    int key1;
+    int key2;
+    long long index;
+    bool operator>(const DStarOpenNode& other) const
+    {
+        return key1 > other.key1 || (key1 == other.key1 && key2 > other.key2);
+    }
+};
+
+// How the path to the chosen pose is planned
+enum class Planner {
+    // A* over the poses, from scratch for every path
+    BEST_PATH,
+    // D* Lite, repairing the previous search while the goal stays the same
+    INCREMENTAL,
+    // HPA*, planning the moves only up to the cluster after the next one
+    HIERARCHICAL,
+    // A breadth-first search over the poses from the robot, which chooses the
+    // nearest informative pose by travel cost and plans the path to it at once
+    DISTANCE_FIELD,
+};
+
+// Large enough to be unreachable, small enough to never overflow when a
+// heuristic is added to it
+const int INFINITE_COST = INT_MAX / 4;
+
+class FastDeterministicAlgorithm final : public AlgorithmState {
+private:
+    Planner m_planner;
+    std::vector<Vector2> m_found_obstacles;
+    Move m_next_move;
+    // The planned moves, the next one last
+    std::vector<Move> m_move_list;
+    int m_old_obstacle_amount;
+    // What has changed since the last plot
+    int m_plotted_obstacle_amount;
+    std::vector<Vector2> m_new_seen_spaces;
+    bool m_has_path_changed;
+    std::vector<Vector2> m_path;
+    // The pose the robot is heading for, and its information value when it
+    // was chosen. Robots of a fleet replan once others have seen part of it.
+    long long m_goal_index;
+    int m_goal_information_value;
+    // What the other robots of a fleet have plotted that has been merged
+    // into the maps, and the space of the robot that blocked the last move
+    int m_fleet_obstacle_amount;
+    int m_fleet_seen_space_amount;
+    bool m_was_blocked;
+    Vector2 m_blocked_position;
+    // The cells the rest of the path drives through, so that a new obstacle
+    // can be checked against the path in O(1), and whether one was on it
+    OccupancyGrid m_path_grid;
+    std::vector<Vector2> m_path_cells;
+    bool m_is_path_blocked;
+    OccupancyGrid m_found_obstacle_grid;
+    // Previously seen spaces. The grid has a border of one cell around the
+    // real grid, since the robot also sees the spaces just outside of it.
+    OccupancyGrid m_seen_grid;
+    // The information value of every pose, indexed by pose index, and how
+    // many poses have each information value. Both are updated by sense as
+    // spaces are seen and obstacles are found. This and the node data below
+    // are paged arrays, so large worlds only take memory where the robot has
+    // been and searched.
+    PagedArray<unsigned char> m_information_values;
+    long long m_information_value_amounts[4];
+    // A* node data, indexed by pose index. A node's data is only valid if its
+    // search stamp equals the stamp of the current search, which means the
+    // arrays never have to be cleared between searches.
+    PagedArray<unsigned int> m_search_stamps;
+    PagedArray<int> m_g_costs;
+    PagedArray<long long> m_parents;
+    PagedArray<unsigned char> m_is_closed;
+    unsigned int m_current_search_stamp;
+    // The open list is kept between searches too, so that planning does not
+    // allocate once the list has grown to the size searches need
+    MinHeap<OpenNode> m_open_list;
+    // The queue of the distance field search, kept for the same reason
+    std::vector<long long> m_field_queue;
+    // Incremental planner state, kept between calls as long as the goal does
+    // not change
+    PagedArray<DStarNode> m_dstar_nodes;
+    MinHeap<DStarOpenNode> m_dstar_open_list;
+    unsigned int m_dstar_stamp;
+    long long m_dstar_goal_index;
+    long long m_dstar_last_start_index;
+    int m_dstar_key_modifier;
+    int m_dstar_known_obstacle_amount;
+    // Hierarchical planner state, whose clusters are kept up to date with the
+    // found obstacles
+    HierarchicalPlanner m_hierarchical_planner;
+    // Planner statistics
+    long long m_replan_amount;
+    // Plans that kept the path since the new obstacles were not on it
+    long long m_avoided_replan_amount;
+    long long m_expanded_node_amount;
+    long long m_maximum_expanded_node_amount;
+    long long m_abstract_expanded_node_amount;
+    // Helper functions
+    void count_replan(long long expanded_node_amount);
+    void start_search(long long node_amount);
+    void follow_parents(long long start_index, long long end_index, int grid_width, std::vector<Move>& move_list);
+    void reset_maps(int grid_width, int grid_height);
+    void add_found_obstacle(Vector2, int grid_width);
+    void mark_path_cells(Pose start);
+    void back_off(RobotServer&, Pose);
+    void add_seen_space(Vector2, int grid_width, int grid_height);
+    void set_information_value(long long index, int information_value);
+    int calculate_information_value(Pose);
+    DStarNode& dstar_node(long long index);
+    void dstar_push(long long index, Vector2 start, int grid_width);
+    void dstar_update_node(long long index, Vector2 start, int grid_width, int grid_height);
+    int dstar_successors(long long index, int grid_width, int grid_height, long long successors[3]);
+    long long dstar_compute_shortest_path(long long start_index, int grid_width, int grid_height);
+public:
+    FastDeterministicAlgorithm(Planner);
+    void reset();
+    void sense(RobotServer&);
+    void plan(RobotServer&);
+    void act(RobotServer&);
+    void plot(RobotServer&, Plotter&);
+    void report(std::ostream&);
+    // Planning steps, public so that they can be benchmarked on their own.
+    // The paths replace the moves of the move list, the first move last, and
+    // are empty if there is no path.
+    Pose calculate_next_pose(RobotServer&);
+    void calculate_best_path(RobotServer&, Pose, Pose, std::vector<Move>& move_list);
+    void calculate_incremental_path(RobotServer&, Pose, Pose, std::vector<Move>& move_list);
+    // Only plans the moves up to the waypoint of the hierarchical planner, so
+    // the path may end before the end pose
+    void calculate_hierarchical_path(RobotServer&, Pose, Pose, std::vector<Move>& move_list);
+    // Chooses the next pose among the reachable poses by travel cost, and
+    // plans the path to it in the same search. Returns the start if no
+    // informative pose can be reached.
+    Pose calculate_informative_path(RobotServer&, Pose start, std::vector<Move>& move_list);
+};
 
-// Function adding random algorithm to application
+// Function adding fast deterministic algorithm to application
 void add_fast_deterministic_algorithm(Application&);
 
 // End header guard
@@ -52,6 +52,21 @@ bool is_member(const std::vector<Vector2>& vector, Vector2 possible_element)
     return found;
 }
 
+void add_fleet_obstacles(RobotServer& server, std::vector<Vector2>& obstacles, int& looked_at_amount)
+{
+    if (server.get_robot_amount() == 1) {
+        return;
+    }
+
+    // The plotted obstacles include the robot's own, which it already knows
+    const std::vector<Vector2>& plotted_obstacles = server.get_plotted_obstacles();
+    for (; looked_at_amount < plotted_obstacles.size(); looked_at_amount++) {
+        if (!is_member(obstacles, plotted_obstacles[looked_at_amount])) {
+            obstacles.push_back(plotted_obstacles[looked_at_amount]);
+        }
+    }
+}
+
 void perform_move(RobotServer& server, Move move)
 {
     switch (move) {
@@ -88,6 +103,15 @@ void add_newly_found_obstacles(std::vector<Vector2>& obstacles,
     }
 }
 
+void add_scanned_obstacles(std::vector<Vector2>& obstacles, const SensorScan& scan)
+{
+    for (Vector2 obstacle : scan.hit_cells) {
+        if (!is_member(obstacles, obstacle)) {
+            obstacles.push_back(obstacle);
+        }
+    }
+}
+
 Move number_to_move(int number)
 {
     Move move;
@@ -17,6 +17,13 @@ struct Surroundings {
     Vector2 right;
 };
 
+// This data structure holds a position of the robot along with its
+// orientation.
+struct Pose {
+    Vector2 position;
+    int orientation;
+};
+
 // This enum is useful for planning a move without performing it.
 enum class Move {
     TURN_LEFT,
@@ -41,6 +48,16 @@ bool is_member(const std::vector<Vector2>&, Vector2);
 // function to know to what positions the sensor data refers.
 void add_newly_found_obstacles(std::vector<Vector2>&, const SensorData&, const Surroundings&);
 
+// This function does the same as the function above for a scan of the range
+// sensor, adding the obstacles the scan hit that are not known yet.
+void add_scanned_obstacles(std::vector<Vector2>&, const SensorScan&);
+
+// This function adds to the obstacles vector (second argument) the obstacles
+// plotted by the other robots of a fleet since the last call. The amount of
+// plotted obstacles already looked at is kept in the last argument. It does
+// nothing for a single robot.
+void add_fleet_obstacles(RobotServer&, std::vector<Vector2>&, int& looked_at_amount);
+
 // This function performs a move based on a move enum. Pseudocode:
 // If move is TURN_LEFT, call server.turn_left()
 // If move is MOVE_FORWARD, call server.move_forward()
@@ -0,0 +1,374 @@
+// Includes
+#include "hierarchical_planner.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+// Using namespace
+using namespace std;
+
+// Local constants
+// Keys of abstract nodes are the cluster index times this plus the node's
+// index in the cluster. A cluster has at most eight nodes per side.
+static const long long MAX_CLUSTER_NODES = 64;
+// The key of the end in the open list
+static const long long END_KEY = -2;
+// Stretches of free cells at least this long get a node at either end
+// rather than one in the middle, as in the original HPA*
+static const int LONG_ENTRANCE_LENGTH = 6;
+
+// Local function prototypes
+static int calculate_distance(Vector2, Vector2);
+static int calculate_orientation(Vector2 from, Vector2 to);
+
+HierarchicalPlanner::HierarchicalPlanner()
+    : m_grid_width(0), m_grid_height(0), m_cluster_columns(0), m_search_stamp(0), m_expanded_node_amount(0)
+{
+}
+
+void HierarchicalPlanner::reset(int grid_width, int grid_height)
+{
+    m_grid_width = grid_width;
+    m_grid_height = grid_height;
+    m_cluster_columns = (grid_width + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+    long long cluster_rows = (grid_height + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+
+    Cluster empty_cluster;
+    empty_cluster.is_valid = false;
+    m_clusters.assign(m_cluster_columns * cluster_rows, empty_cluster);
+}
+
+// An obstacle on the side of a cluster also changes the nodes of the
+// neighbouring cluster on that side
+void HierarchicalPlanner::add_obstacle(Vector2 obstacle)
+{
+    long long cluster_x = obstacle.x / CLUSTER_SIZE;
+    long long cluster_y = obstacle.y / CLUSTER_SIZE;
+
+    invalidate_cluster(cluster_x, cluster_y);
+    if (obstacle.x % CLUSTER_SIZE == 0 && obstacle.x > 0) {
+        invalidate_cluster(cluster_x - 1, cluster_y);
+    }
+    if (obstacle.x % CLUSTER_SIZE == CLUSTER_SIZE - 1 && obstacle.x < m_grid_width - 1) {
+        invalidate_cluster(cluster_x + 1, cluster_y);
+    }
+    if (obstacle.y % CLUSTER_SIZE == 0 && obstacle.y > 0) {
+        invalidate_cluster(cluster_x, cluster_y - 1);
+    }
+    if (obstacle.y % CLUSTER_SIZE == CLUSTER_SIZE - 1 && obstacle.y < m_grid_height - 1) {
+        invalidate_cluster(cluster_x, cluster_y + 1);
+    }
+}
+
+bool HierarchicalPlanner::find_waypoint(const OccupancyGrid& obstacles, Pose start, Pose end, Pose& waypoint)
+{
+    long long start_cluster_index = calculate_cluster_index(start.position);
+    long long end_cluster_index = calculate_cluster_index(end.position);
+    m_expanded_node_amount = 0;
+
+    // Within the clusters the path would be refined for anyway, the flat
+    // planner is cheap enough. Most goals of an exploration are that close.
+    if (abs(start.position.x / CLUSTER_SIZE - end.position.x / CLUSTER_SIZE) <= 1 &&
+        abs(start.position.y / CLUSTER_SIZE - end.position.y / CLUSTER_SIZE) <= 1) {
+        waypoint = end;
+        return true;
+    }
+
+    // Start a new search. Node data is only cleared when the stamps wrap
+    // around, by building every cluster again.
+    m_search_stamp++;
+    if (m_search_stamp == 0) {
+        reset(m_grid_width, m_grid_height);
+        m_search_stamp = 1;
+    }
+    m_open_list.clear();
+
+    Cluster& end_cluster = get_cluster(obstacles, end_cluster_index);
+    search_cluster(obstacles, end_cluster_index, end.position);
+    m_end_distances.clear();
+    for (const ClusterNode& node : end_cluster.nodes) {
+        m_end_distances.push_back(get_cell_distance(end_cluster_index, node.cell));
+    }
+
+    // The start is connected to the nodes of its cluster it can reach
+    Cluster& start_cluster = get_cluster(obstacles, start_cluster_index);
+    search_cluster(obstacles, start_cluster_index, start.position);
+    for (int i = 0; i < start_cluster.nodes.size(); i++) {
+        int distance = get_cell_distance(start_cluster_index, start_cluster.nodes[i].cell);
+        if (distance >= 0) {
+            push_node(start_cluster, start_cluster_index, i, distance, -1, end.position);
+        }
+    }
+
+    int end_cost = INT_MAX;
+    long long end_parent = -1;
+    bool has_succeeded = false;
+
+    while (!has_succeeded && !m_open_list.empty()) {
+        AbstractOpenNode top = m_open_list.top();
+        m_open_list.pop();
+
+        if (top.key == END_KEY) {
+            // Older entries of the end had a higher cost
+            has_succeeded = top.F == end_cost;
+            continue;
+        }
+
+        long long cluster_index = top.key / MAX_CLUSTER_NODES;
+        int node_index = top.key % MAX_CLUSTER_NODES;
+        Cluster& cluster = get_cluster(obstacles, cluster_index);
+        ClusterNode& node = cluster.nodes[node_index];
+
+        // Skip stale entries of nodes that were already expanded
+        if (node.is_closed) {
+            continue;
+        }
+        node.is_closed = true;
+        m_expanded_node_amount++;
+
+        if (cluster_index == end_cluster_index && m_end_distances[node_index] >= 0 &&
+            node.g + m_end_distances[node_index] < end_cost) {
+            end_cost = node.g + m_end_distances[node_index];
+            end_parent = top.key;
+            m_open_list.push({end_cost, 0, END_KEY});
+        }
+
+        // Through the cluster to its other nodes
+        int node_amount = cluster.nodes.size();
+        for (int i = 0; i < node_amount; i++) {
+            int distance = cluster.distances[node_index * node_amount + i];
+            if (i != node_index && distance >= 0) {
+                push_node(cluster, cluster_index, i, node.g + distance, top.key, end.position);
+            }
+        }
+
+        // Across the side to the neighbouring clusters
+        for (int i = 0; i < node.partner_amount; i++) {
+            Vector2 partner = node.partners[i];
+            long long partner_cluster_index = calculate_cluster_index(partner);
+            Cluster& partner_cluster = get_cluster(obstacles, partner_cluster_index);
+
+            for (int j = 0; j < partner_cluster.nodes.size(); j++) {
+                if (partner_cluster.nodes[j].cell == partner) {
+                    push_node(partner_cluster, partner_cluster_index, j, node.g + 1, top.key, end.position);
+                }
+            }
+        }
+    }
+
+    if (!has_succeeded) {
+        return false;
+    }
+
+    m_abstract_path.clear();
+    for (long long key = end_parent; key != -1;) {
+        m_abstract_path.push_back(key);
+        key = get_cluster(obstacles, key / MAX_CLUSTER_NODES).nodes[key % MAX_CLUSTER_NODES].parent;
+    }
+
+    // Follow the path from the start until it enters its third cluster
+    long long cluster_index = start_cluster_index;
+    int cluster_change_amount = 0;
+    Vector2 previous_cell = start.position;
+
+    for (int i = m_abstract_path.size() - 1; i >= 0; i--) {
+        long long key = m_abstract_path[i];
+        Vector2 cell = get_cluster(obstacles, key / MAX_CLUSTER_NODES).nodes[key % MAX_CLUSTER_NODES].cell;
+
+        if (key / MAX_CLUSTER_NODES != cluster_index) {
+            cluster_index = key / MAX_CLUSTER_NODES;
+            cluster_change_amount++;
+            if (cluster_change_amount == 2) {
+                waypoint.position = cell;
+                waypoint.orientation = calculate_orientation(previous_cell, cell);
+                return true;
+            }
+        }
+        previous_cell = cell;
+    }
+
+    waypoint = end;
+    return true;
+}
+
+long long HierarchicalPlanner::get_expanded_node_amount() const
+{
+    return m_expanded_node_amount;
+}
+
+long long HierarchicalPlanner::calculate_cluster_index(Vector2 cell) const
+{
+    return cell.y / CLUSTER_SIZE * m_cluster_columns + cell.x / CLUSTER_SIZE;
+}
+
+void HierarchicalPlanner::invalidate_cluster(long long cluster_x, long long cluster_y)
+{
+    long long cluster_index = cluster_y * m_cluster_columns + cluster_x;
+
+    // Reading first keeps clusters that were never built from being allocated
+    if (m_clusters.get(cluster_index).is_valid) {
+        m_clusters[cluster_index].is_valid = false;
+    }
+}
+
+Cluster& HierarchicalPlanner::get_cluster(const OccupancyGrid& obstacles, long long cluster_index)
+{
+    Cluster& cluster = m_clusters[cluster_index];
+    if (!cluster.is_valid) {
+        build_cluster(obstacles, cluster_index, cluster);
+    }
+    return cluster;
+}
+
+// Finds the stretches of cells along every side of the cluster that are free
+// on both sides of it, and connects the nodes through the cluster
+void HierarchicalPlanner::build_cluster(const OccupancyGrid& obstacles, long long cluster_index, Cluster& cluster)
+{
+    int x0 = cluster_index % m_cluster_columns * CLUSTER_SIZE;
+    int y0 = cluster_index / m_cluster_columns * CLUSTER_SIZE;
+    int x1 = min(x0 + CLUSTER_SIZE, m_grid_width);
+    int y1 = min(y0 + CLUSTER_SIZE, m_grid_height);
+
+    // The left, right, bottom and top sides
+    Vector2 first_cells[4] = {Vector2(x0, y0), Vector2(x1 - 1, y0), Vector2(x0, y0), Vector2(x0, y1 - 1)};
+    Vector2 steps[4] = {Vector2(0, 1), Vector2(0, 1), Vector2(1, 0), Vector2(1, 0)};
+    Vector2 outwards[4] = {Vector2(-1, 0), Vector2(1, 0), Vector2(0, -1), Vector2(0, 1)};
+    int lengths[4] = {y1 - y0, y1 - y0, x1 - x0, x1 - x0};
+
+    cluster.nodes.clear();
+    for (int side = 0; side < 4; side++) {
+        int stretch_start = -1;
+
+        for (int i = 0; i <= lengths[side]; i++) {
+            bool is_free = false;
+            if (i < lengths[side]) {
+                Vector2 cell(first_cells[side].x + steps[side].x * i, first_cells[side].y + steps[side].y * i);
+                Vector2 partner = cell + outwards[side];
+                is_free = obstacles.is_in_bounds(partner) && !obstacles.is_occupied(cell) &&
+                          !obstacles.is_occupied(partner);
+            }
+
+            if (is_free && stretch_start == -1) {
+                stretch_start = i;
+            } else if (!is_free && stretch_start != -1) {
+                int stretch_end = i - 1;
+                int node_positions[2] = {stretch_start, stretch_end};
+                int node_position_amount = 2;
+                if (stretch_end - stretch_start + 1 < LONG_ENTRANCE_LENGTH) {
+                    node_positions[0] = (stretch_start + stretch_end) / 2;
+                    node_position_amount = 1;
+                }
+
+                for (int j = 0; j < node_position_amount; j++) {
+                    Vector2 cell(first_cells[side].x + steps[side].x * node_positions[j],
+                                 first_cells[side].y + steps[side].y * node_positions[j]);
+                    add_cluster_node(cluster, cell, cell + outwards[side]);
+                }
+                stretch_start = -1;
+            }
+        }
+    }
+
+    int node_amount = cluster.nodes.size();
+    cluster.distances.assign(node_amount * node_amount, -1);
+    for (int i = 0; i < node_amount; i++) {
+        search_cluster(obstacles, cluster_index, cluster.nodes[i].cell);
+        for (int j = 0; j < node_amount; j++) {
+            cluster.distances[i * node_amount + j] = get_cell_distance(cluster_index, cluster.nodes[j].cell);
+        }
+    }
+    cluster.is_valid = true;
+}
+
+// Corner cells are on two sides, so they can already be a node
+void HierarchicalPlanner::add_cluster_node(Cluster& cluster, Vector2 cell, Vector2 partner)
+{
+    for (ClusterNode& node : cluster.nodes) {
+        if (node.cell == cell) {
+            node.partners[node.partner_amount++] = partner;
+            return;
+        }
+    }
+
+    ClusterNode node;
+    node.cell = cell;
+    node.partners[0] = partner;
+    node.partner_amount = 1;
+    node.stamp = 0;
+    node.g = 0;
+    node.parent = -1;
+    node.is_closed = false;
+    cluster.nodes.push_back(node);
+}
+
+// Breadth-first search from the source through the free cells of its
+// cluster, leaving the distances in m_cell_distances
+void HierarchicalPlanner::search_cluster(const OccupancyGrid& obstacles, long long cluster_index, Vector2 source)
+{
+    int x0 = cluster_index % m_cluster_columns * CLUSTER_SIZE;
+    int y0 = cluster_index / m_cluster_columns * CLUSTER_SIZE;
+    int x1 = min(x0 + CLUSTER_SIZE, m_grid_width);
+    int y1 = min(y0 + CLUSTER_SIZE, m_grid_height);
+    Vector2 directions[4] = {Vector2(0, 1), Vector2(-1, 0), Vector2(0, -1), Vector2(1, 0)};
+
+    m_cell_distances.assign(CLUSTER_SIZE * CLUSTER_SIZE, -1);
+    m_queue.clear();
+    m_cell_distances[(source.y - y0) * CLUSTER_SIZE + source.x - x0] = 0;
+    m_queue.push_back(source);
+
+    for (int i = 0; i < m_queue.size(); i++) {
+        Vector2 cell = m_queue[i];
+        int distance = m_cell_distances[(cell.y - y0) * CLUSTER_SIZE + cell.x - x0] + 1;
+
+        for (Vector2 direction : directions) {
+            Vector2 next = cell + direction;
+            if (next.x >= x0 && next.x < x1 && next.y >= y0 && next.y < y1 &&
+                m_cell_distances[(next.y - y0) * CLUSTER_SIZE + next.x - x0] == -1 &&
+                !obstacles.is_occupied(next)) {
+                m_cell_distances[(next.y - y0) * CLUSTER_SIZE + next.x - x0] = distance;
+                m_queue.push_back(next);
+            }
+        }
+    }
+}
+
+int HierarchicalPlanner::get_cell_distance(long long cluster_index, Vector2 cell) const
+{
+    int x0 = cluster_index % m_cluster_columns * CLUSTER_SIZE;
+    int y0 = cluster_index / m_cluster_columns * CLUSTER_SIZE;
+    return m_cell_distances[(cell.y - y0) * CLUSTER_SIZE + cell.x - x0];
+}
+
+void HierarchicalPlanner::push_node(Cluster& cluster, long long cluster_index, int node_index, int g,
+                                    long long parent, Vector2 end)
+{
+    ClusterNode& node = cluster.nodes[node_index];
+
+    if (node.stamp != m_search_stamp || (!node.is_closed && g < node.g)) {
+        int H = calculate_distance(node.cell, end);
+        node.stamp = m_search_stamp;
+        node.g = g;
+        node.parent = parent;
+        node.is_closed = false;
+        m_open_list.push({g + H, H, cluster_index * MAX_CLUSTER_NODES + node_index});
+    }
+}
+
+int calculate_distance(Vector2 v1, Vector2 v2)
+{
+    // Uses manhattan distance
+    return abs(v1.x - v2.x) + abs(v1.y - v2.y);
+}
+
+// The orientation of a robot moving between the neighbouring cells
+int calculate_orientation(Vector2 from, Vector2 to)
+{
+    if (to.y > from.y) {
+        return 0;
+    } else if (to.x < from.x) {
+        return 1;
+    } else if (to.y < from.y) {
+        return 2;
+    }
+    return 3;
+}
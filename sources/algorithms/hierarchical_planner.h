@@ -0,0 +1,96 @@
+// Begin header guard
+#ifndef HIERARCHICAL_PLANNER_H
+#define HIERARCHICAL_PLANNER_H
+
+// Includes
+#include "../min_heap.h"
+#include "../occupancy_grid.h"
+#include "../paged_array.h"
+#include "helper_functions.h"
+#include <vector>
+
+// A node of the abstract graph: a free cell on the side of a cluster with a
+// free cell of the neighbouring cluster right across from it, its partner.
+// Cells on a corner of a cluster can have a partner on both sides.
+struct ClusterNode {
+    Vector2 cell;
+    Vector2 partners[2];
+    int partner_amount;
+    // Search data, only valid if the stamp is the stamp of the current search
+    unsigned int stamp;
+    int g;
+    long long parent;
+    bool is_closed;
+};
+
+// A square of cells of the grid. Its nodes and the distances between them
+// through the cluster are built when a search first needs them, and built
+// again once an obstacle was found in or next to the cluster.
+struct Cluster {
+    bool is_valid;
+    std::vector<ClusterNode> nodes;
+    // The distance from every node to every other node, by row, or -1 if the
+    // cluster has no free path between them
+    std::vector<int> distances;
+};
+
+struct AbstractOpenNode {
+    int F;
+    int H;
+    long long key;
+    bool operator>(const AbstractOpenNode& other) const
+    {
+        return F > other.F || (F == other.F && H > other.H);
+    }
+};
+
+// Hierarchical path finding (HPA*, Botea, Mueller and Schaeffer) over the
+// known obstacles, treating unknown cells as free like the flat planner. The
+// grid is split into clusters, and every stretch of free cells along the
+// side shared by two clusters gets a node on either side. A search first
+// finds a path through these nodes, which only looks at a few cells per
+// cluster, and the robot then only plans its moves up to where that path
+// enters the cluster after the next one.
+class HierarchicalPlanner {
+private:
+    int m_grid_width;
+    int m_grid_height;
+    long long m_cluster_columns;
+    PagedArray<Cluster> m_clusters;
+    MinHeap<AbstractOpenNode> m_open_list;
+    unsigned int m_search_stamp;
+    // Breadth-first search buffers, the distances covering one cluster
+    std::vector<int> m_cell_distances;
+    std::vector<Vector2> m_queue;
+    // The distances from the nodes of the end's cluster to the end
+    std::vector<int> m_end_distances;
+    // The nodes of the last abstract path, from the end back to the start
+    std::vector<long long> m_abstract_path;
+    long long m_expanded_node_amount;
+    long long calculate_cluster_index(Vector2) const;
+    void invalidate_cluster(long long cluster_x, long long cluster_y);
+    Cluster& get_cluster(const OccupancyGrid&, long long cluster_index);
+    void build_cluster(const OccupancyGrid&, long long cluster_index, Cluster&);
+    void add_cluster_node(Cluster&, Vector2 cell, Vector2 partner);
+    void search_cluster(const OccupancyGrid&, long long cluster_index, Vector2 source);
+    int get_cell_distance(long long cluster_index, Vector2) const;
+    void push_node(Cluster&, long long cluster_index, int node, int g, long long parent, Vector2 end);
+public:
+    static const int CLUSTER_SIZE = 16;
+    HierarchicalPlanner();
+    // Forgets every cluster, for a new run or a grid of a different size
+    void reset(int grid_width, int grid_height);
+    // Makes the clusters whose nodes or distances a new obstacle changes be
+    // built again when they are next needed
+    void add_obstacle(Vector2);
+    // Sets the waypoint to the pose to plan the robot's moves to: the pose at
+    // which the abstract path enters the cluster after the next one, or the
+    // end if it is closer than that. Returns false if the known obstacles
+    // leave no path to the end.
+    bool find_waypoint(const OccupancyGrid& obstacles, Pose start, Pose end, Pose& waypoint);
+    // The amount of nodes the last abstract search expanded
+    long long get_expanded_node_amount() const;
+};
+
+// End header guard
+#endif
@@ -6,39 +6,46 @@
 // Using namespace
 using namespace std;
 
-// Globals (local to this file)
-static vector<Vector2> gl_found_obstacles;
-static vector<Vector2> gl_previous_positions;
-static Move gl_next_move;
-
-// Function prototypes
-static void sense(RobotServer&);
-static void plan(RobotServer&);
-static void act(RobotServer&);
-static void plot(RobotServer&, Plotter&);
+// Local function prototypes
+static AlgorithmState* create_state();
 
 void add_no_backtrack_random_algorithm(Application& app)
 {
-    app.add_algorithm("no_backtrack_random", sense, plan, act, plot);
+    app.add_algorithm("no_backtrack_random", create_state, run_headless<NoBacktrackRandomAlgorithm>);
 }
 
-void sense(RobotServer& server)
+AlgorithmState* create_state()
 {
-    SensorData data = server.read_sensor();
-    Surroundings surroundings = calculate_robot_surroundings(server);
+    return new NoBacktrackRandomAlgorithm();
+}
 
-    add_newly_found_obstacles(gl_found_obstacles, data, surroundings);
+NoBacktrackRandomAlgorithm::NoBacktrackRandomAlgorithm()
+{
+    reset();
+}
+
+void NoBacktrackRandomAlgorithm::reset()
+{
+    m_found_obstacles.clear();
+    m_fleet_obstacle_amount = 0;
+    m_previous_positions.clear();
+}
+
+void NoBacktrackRandomAlgorithm::sense(RobotServer& server)
+{
+    add_scanned_obstacles(m_found_obstacles, server.read_scan());
+    add_fleet_obstacles(server, m_found_obstacles, m_fleet_obstacle_amount);
 
     // Add to previous positions
-    gl_previous_positions.push_back(server.get_position());
+    m_previous_positions.push_back(server.get_position());
 
     // Stop server if you have found all obstacles
-    if (gl_found_obstacles.size() == server.get_obstacle_amount()) {
+    if (m_found_obstacles.size() == server.get_obstacle_amount()) {
         server.stop();
     }
 }
 
-void plan(RobotServer& server)
+void NoBacktrackRandomAlgorithm::plan(RobotServer& server)
 {
     Surroundings surroundings = calculate_robot_surroundings(server);
 
@@ -48,7 +55,7 @@ void plan(RobotServer& server)
     int grid_height = server.get_grid_height();
 
     // Check if obstacle is in front of the robot
-    bool is_obstacle_in_front = is_member(gl_found_obstacles, front);
+    bool is_obstacle_in_front = is_member(m_found_obstacles, front);
 
     // Check if the front of the robot would be outside the grid
     bool is_front_out_of_grid;
@@ -59,25 +66,22 @@ void plan(RobotServer& server)
     }
 
     // Check if the front of the robot is a previous position
-    bool is_front_previous = is_member(gl_previous_positions, front);
-
-    // Generate random number between zero and RAND_MAX
-    int number = rand();
+    bool is_front_previous = is_member(m_previous_positions, front);
 
     // Determine next move
     if (is_obstacle_in_front || is_front_out_of_grid || is_front_previous) {
-        gl_next_move = number_to_move(number % 2);
+        m_next_move = number_to_move(server.generate_random_number(2));
     } else {
-        gl_next_move = number_to_move(number % 3);
+        m_next_move = number_to_move(server.generate_random_number(3));
     }
 }
 
-void act(RobotServer& server)
+void NoBacktrackRandomAlgorithm::act(RobotServer& server)
 {
-    perform_move(server, gl_next_move);
+    perform_move(server, m_next_move);
 }
 
-void plot(RobotServer& server, Plotter& plotter)
+void NoBacktrackRandomAlgorithm::plot(RobotServer& server, Plotter& plotter)
 {
-    plotter.plot(gl_found_obstacles);
+    plotter.plot(m_found_obstacles);
 }
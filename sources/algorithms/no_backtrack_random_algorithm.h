@@ -4,6 +4,24 @@
 #define SMARTER_RANDOM_ALGORITHM_H
 
 #include "../application.h"
+#include "helper_functions.h"
+#include <vector>
+
+class NoBacktrackRandomAlgorithm final : public AlgorithmState {
+private:
+    std::vector<Vector2> m_found_obstacles;
+    // Plotted obstacles already added, see add_fleet_obstacles
+    int m_fleet_obstacle_amount;
+    std::vector<Vector2> m_previous_positions;
+    Move m_next_move;
+public:
+    NoBacktrackRandomAlgorithm();
+    void reset();
+    void sense(RobotServer&);
+    void plan(RobotServer&);
+    void act(RobotServer&);
+    void plot(RobotServer&, Plotter&);
+};
 
 // Function adding random algorithm to application
 void add_no_backtrack_random_algorithm(Application&);
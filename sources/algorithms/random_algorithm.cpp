@@ -2,41 +2,47 @@
 // Includes
 #include "random_algorithm.h"
 #include "helper_functions.h"
-#include <cstdlib>
 #include <vector>
 
 // Using namespace
 using namespace std;
 
-// Globals (local to this file)
-static vector<Vector2> gl_found_obstacles;
-static Move gl_next_move;
-
 // Local function prototypes
-static void sense(RobotServer&);
-static void plan(RobotServer&);
-static void act(RobotServer&);
-static void plot(RobotServer&, Plotter&);
+static AlgorithmState* create_state();
 
 void add_random_algorithm(Application& app)
 {
-    app.add_algorithm("random", sense, plan, act, plot);
+    app.add_algorithm("random", create_state, run_headless<RandomAlgorithm>);
 }
 
-void sense(RobotServer& server)
+AlgorithmState* create_state()
 {
-    SensorData data = server.read_sensor();
-    Surroundings surroundings = calculate_robot_surroundings(server);
+    return new RandomAlgorithm();
+}
 
-    add_newly_found_obstacles(gl_found_obstacles, data, surroundings);
+RandomAlgorithm::RandomAlgorithm()
+{
+    reset();
+}
+
+void RandomAlgorithm::reset()
+{
+    m_found_obstacles.clear();
+    m_fleet_obstacle_amount = 0;
+}
+
+void RandomAlgorithm::sense(RobotServer& server)
+{
+    add_scanned_obstacles(m_found_obstacles, server.read_scan());
+    add_fleet_obstacles(server, m_found_obstacles, m_fleet_obstacle_amount);
 
     // Stop server if you have found all obstacles
-    if (gl_found_obstacles.size() == server.get_obstacle_amount()) {
+    if (m_found_obstacles.size() == server.get_obstacle_amount()) {
         server.stop();
     }
 }
 
-void plan(RobotServer& server)
+void RandomAlgorithm::plan(RobotServer& server)
 {
     Surroundings surroundings = calculate_robot_surroundings(server);
 
@@ -46,7 +52,7 @@ void plan(RobotServer& server)
     int grid_height = server.get_grid_height();
 
     // Check if obstacle is in front of the robot
-    bool is_obstacle_in_front = is_member(gl_found_obstacles, front);
+    bool is_obstacle_in_front = is_member(m_found_obstacles, front);
 
     // Check if the front of the robot would be outside the grid
     bool is_front_out_of_grid;
@@ -56,24 +62,21 @@ void plan(RobotServer& server)
         is_front_out_of_grid = false;
     }
 
-    // Generate random number between zero and RAND_MAX
-    int number = rand();
-
     if (is_obstacle_in_front || is_front_out_of_grid) { // If you cannot move forward
         // Only turn the robot either left or right
-        gl_next_move = number_to_move(number % 2);
+        m_next_move = number_to_move(server.generate_random_number(2));
     } else {
         // Make the robot turn left, turn right, or move forward
-        gl_next_move = number_to_move(number % 3);
+        m_next_move = number_to_move(server.generate_random_number(3));
     }
 }
 
-void act(RobotServer& server)
+void RandomAlgorithm::act(RobotServer& server)
 {
-    perform_move(server, gl_next_move);
+    perform_move(server, m_next_move);
 }
 
-void plot(RobotServer& server, Plotter& plotter)
+void RandomAlgorithm::plot(RobotServer& server, Plotter& plotter)
 {
-    plotter.plot(gl_found_obstacles);
+    plotter.plot(m_found_obstacles);
 }
@@ -2,21 +2,67 @@
 // Includes
 #include "application.h"
 #include "algorithms/algorithms.h"
-#include <cstdlib>
-#include <ctime>
+#include "world_map.h"
+#include <algorithm>
+#include <climits>
 #include <iostream>
+#include <sstream>
+#include <thread>
+#include <utility>
 
-Application::Application(const Parameters& parameters) : m_server(*this), m_plotter(*this)
+// Local constants
+// Records between keyframes of recorded traces
+static const int KEYFRAME_INTERVAL = 1024;
+// Mixed into the seed for the random numbers of each robot after robot zero
+static const unsigned long long ROBOT_SEED_STEP = 0x9e3779b97f4a7c15ULL;
+
+AlgorithmState::~AlgorithmState()
+{
+}
+
+void AlgorithmState::report(std::ostream&)
+{
+}
+
+Application::Application(const Parameters& parameters)
 {
     // Add algorithms
     add_algorithms(*this);
 
-    process_parameters(parameters);
-
-    m_robot_position.x = 0;
-    m_robot_position.y = 0;
-    m_robot_orientation = 1;
+    m_is_parallel = true;
+    // Until the size of the world is known
+    m_grid_width = 1;
+    m_grid_height = 1;
+    create_robots(1);
+    reset_robots(parameters.seed);
     m_number_of_iterations = 0;
+    m_is_quiet = false;
+    m_plot_version = 0;
+    m_path_version = 0;
+    m_is_profiling = parameters.is_profiling;
+    m_has_map = false;
+    m_save_map_file = parameters.save_map_file;
+
+    // A replay takes its world from the trace, a map sets the size of the
+    // world and its obstacles
+    if (!parameters.replay_file.empty()) {
+        start_replay(parameters);
+    } else if (parameters.map_file.empty() || open_map(parameters.map_file)) {
+        Parameters world_parameters = parameters;
+        if (m_has_map) {
+            world_parameters.grid_width = m_grid_width;
+            world_parameters.grid_height = m_grid_height;
+            world_parameters.obstacle_amount = m_obstacle_amount;
+        }
+        process_parameters(world_parameters);
+        reset_robots(parameters.seed);
+        if (!parameters.record_file.empty() && m_step_type != StepThroughType::NO_MORE_STEPS) {
+            start_recording(parameters);
+        }
+    } else {
+        m_step_type = StepThroughType::NO_MORE_STEPS;
+        m_run_headless = nullptr;
+    }
 }
 
 void Application::process_parameters(const Parameters& parameters)
@@ -27,11 +73,14 @@ void Application::process_parameters(const Parameters& parameters)
     m_algorithm_name = parameters.algorithm;
 
     m_step_type = StepThroughType::NO_MORE_STEPS;
+    m_run_headless = nullptr;
 
     bool is_algorithm_in_algorithms = false;
+    int alg_index = 0;
 
     for (int i = 0; i < m_algorithms.size() && !is_algorithm_in_algorithms; i++) {
         if (m_algorithms[i].name == m_algorithm_name) {
+            alg_index = i;
             is_algorithm_in_algorithms = true;
         }
     }
@@ -42,126 +91,565 @@ void Application::process_parameters(const Parameters& parameters)
         std::cerr << "Grid height is too small." << std::endl;
     } else if (m_obstacle_amount < 1) {
         std::cerr << "Obstacle amount is too small." << std::endl;
-    } else if (m_obstacle_amount >= m_grid_width * m_grid_height) {
+    } else if (m_obstacle_amount > static_cast<long long>(m_grid_width) * m_grid_height -
+                                   std::max(parameters.robot_amount, 1)) {
         std::cerr << "Obstacle amount is too big." << std::endl;
     } else if (!is_algorithm_in_algorithms) {
         std::cerr << "That algorithm is not available." << std::endl;
+    } else if (parameters.robot_amount < 1) {
+        std::cerr << "Robot amount is too small." << std::endl;
+    } else if (m_has_map && !are_start_cells_free(parameters.robot_amount)) {
+        std::cerr << "The map has an obstacle where a robot starts." << std::endl;
+    } else if (parameters.sensor_model.range < 1) {
+        std::cerr << "Sensor range is too small." << std::endl;
+    } else if (parameters.sensor_model.type == SensorType::LIDAR && parameters.sensor_model.ray_amount < 1) {
+        std::cerr << "Ray amount is too small." << std::endl;
     } else {
+        m_sensor.set_model(parameters.sensor_model);
+        create_robots(parameters.robot_amount);
+        for (int i = 0; i < parameters.robot_amount; i++) {
+            m_algorithm_states.emplace_back(m_algorithms[alg_index].create_state());
+        }
+        m_run_headless = m_algorithms[alg_index].run_headless;
         m_step_type = StepThroughType::FIRST_STEP;
     }
 }
 
-void Application::add_algorithm(std::string name, void (*sense)(RobotServer&),
-                                void (*plan)(RobotServer&),
-                                void (*act)(RobotServer&),
-                                void (*plot)(RobotServer&, Plotter&))
+void Application::create_robots(int robot_amount)
 {
-    Algorithm alg = {name, sense, plan, act, plot};
-    m_algorithms.push_back(alg);
+    m_robots.assign(robot_amount, Robot());
+    m_servers.clear();
+    m_plotters.clear();
+    for (int i = 0; i < robot_amount; i++) {
+        m_servers.emplace_back(new RobotServer(*this, i));
+        m_plotters.emplace_back(new Plotter(*this, i));
+    }
+    m_robot_randoms.resize(robot_amount - 1);
+    create_robot_pool();
 }
 
-void Application::print_algorithms()
+// Sensing and planning in parallel only pays off for fleets, and only with
+// more than one core
+void Application::create_robot_pool()
 {
-    for (const Algorithm& alg : m_algorithms) {
-        std::cout << alg.name << std::endl;
+    int thread_amount = std::min<int>(m_robots.size(), std::thread::hardware_concurrency());
+    if (m_is_parallel && thread_amount > 1) {
+        m_robot_pool.reset(new ThreadPool(thread_amount));
+    } else {
+        m_robot_pool.reset();
     }
 }
 
-void Application::step_through()
+// The robots start on the first cells of the grid, row by row from the origin,
+// which are never obstacles. Each faces a different way.
+Vector2 Application::calculate_start_position(int robot)
+{
+    return Vector2(robot % m_grid_width, robot / m_grid_width);
+}
+
+bool Application::are_start_cells_free(int robot_amount)
+{
+    for (int i = 0; i < robot_amount; i++) {
+        if (m_world.is_occupied(calculate_start_position(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Application::reset_robots(unsigned long long seed)
+{
+    for (std::size_t i = 0; i < m_robots.size(); i++) {
+        m_robots[i].position = calculate_start_position(i);
+        m_robots[i].orientation = (1 + i) % 4;
+        m_robots[i].has_stopped = false;
+        m_plotters[i]->reset();
+    }
+
+    m_random.seed(seed);
+    for (std::size_t i = 0; i < m_robot_randoms.size(); i++) {
+        m_robot_randoms[i].seed(seed ^ ((i + 1) * ROBOT_SEED_STEP));
+    }
+}
+
+bool Application::open_map(const std::string& path)
+{
+    long long obstacle_amount;
+
+    if (!load_map(path, m_map_file, m_world, obstacle_amount)) {
+        std::cerr << "Could not read the map file." << std::endl;
+        return false;
+    }
+    if (obstacle_amount > INT_MAX) {
+        std::cerr << "The map has too many obstacles." << std::endl;
+        return false;
+    }
+
+    m_grid_width = m_world.get_width();
+    m_grid_height = m_world.get_height();
+    m_obstacle_amount = obstacle_amount;
+    m_has_map = true;
+    return true;
+}
+
+// Worlds loaded from maps exist from the start. The world is only saved the
+// first time, not again on every restart.
+void Application::generate_world()
+{
+    if (!m_has_map) {
+        generate_random_obstacles();
+    }
+    m_found_obstacle_grid.reset(m_grid_width, m_grid_height);
+    m_seen_space_grid.reset(m_grid_width + 2, m_grid_height + 2);
+    if (!m_save_map_file.empty()) {
+        if (!save_map(m_save_map_file, m_world)) {
+            std::cerr << "Could not save the map." << std::endl;
+        }
+        m_save_map_file.clear();
+    }
+}
+
+void Application::start_recording(const Parameters& parameters)
+{
+    TraceHeader header = {m_grid_width, m_grid_height, m_obstacle_amount, parameters.seed,
+                          m_algorithm_name, KEYFRAME_INTERVAL, m_robots[0].position,
+                          m_robots[0].orientation};
+
+    // Traces follow a single robot
+    if (m_robots.size() > 1) {
+        std::cerr << "Recording is not supported with several robots." << std::endl;
+        m_step_type = StepThroughType::NO_MORE_STEPS;
+        return;
+    }
+
+    m_trace_writer.reset(new TraceWriter());
+    if (!m_trace_writer->open(parameters.record_file, header)) {
+        std::cerr << "Could not open the trace file for writing." << std::endl;
+        m_trace_writer.reset();
+        m_step_type = StepThroughType::NO_MORE_STEPS;
+    }
+}
+
+// The trace is finished as soon as the run is, so that it is complete even if
+// the application lives on
+void Application::record_step()
+{
+    m_trace_writer->write_step(m_robots[0].position, m_robots[0].orientation,
+                               m_servers[0]->read_sensor(), m_found_obstacles);
+    if (m_step_type == StepThroughType::LAST_STEP) {
+        m_trace_writer->finish();
+    }
+}
+
+void Application::start_replay(const Parameters& parameters)
+{
+    m_step_type = StepThroughType::NO_MORE_STEPS;
+    m_run_headless = nullptr;
+
+    m_trace_reader.reset(new TraceReader());
+    if (!m_trace_reader->open(parameters.replay_file)) {
+        std::cerr << "Could not read the trace file." << std::endl;
+        m_trace_reader.reset();
+        return;
+    }
+
+    // A run on a map is replayed on the same map
+    const TraceHeader& header = m_trace_reader->get_header();
+    if (!parameters.map_file.empty()) {
+        if (!open_map(parameters.map_file)) {
+            m_trace_reader.reset();
+            return;
+        }
+        if (m_grid_width != header.grid_width || m_grid_height != header.grid_height ||
+            m_obstacle_amount != header.obstacle_amount) {
+            std::cerr << "The map does not match the trace." << std::endl;
+            m_trace_reader.reset();
+            return;
+        }
+    }
+
+    m_grid_width = header.grid_width;
+    m_grid_height = header.grid_height;
+    m_obstacle_amount = header.obstacle_amount;
+    m_algorithm_name = header.algorithm;
+    m_robots[0].position = header.start_position;
+    m_robots[0].orientation = header.start_orientation;
+    m_random.seed(header.seed);
+
+    if (m_grid_width < 1 || m_grid_height < 1 || m_obstacle_amount < 1 ||
+        m_obstacle_amount >= static_cast<long long>(m_grid_width) * m_grid_height) {
+        std::cerr << "The trace file is broken." << std::endl;
+        m_trace_reader.reset();
+        return;
+    }
+
+    m_step_type = StepThroughType::FIRST_STEP;
+}
+
+// The world is made the way it was for the recorded run, from the recorded
+// seed or the map, and the robot is moved along the recorded poses
+void Application::replay_step()
 {
     switch (m_step_type) {
     case StepThroughType::FIRST_STEP:
-        generate_random_obstacles();
+        generate_world();
         m_step_type = StepThroughType::REGULAR_STEP;
     case StepThroughType::LAST_STEP:
     case StepThroughType::REGULAR_STEP:
-        run_algorithm_once();
+        {
+            // A broken record ends the replay like the end of the trace
+            bool has_read = m_trace_reader->read_step();
+            if (has_read) {
+                apply_trace_state();
+            }
+            if (!has_read || !m_trace_reader->has_next()) {
+                if (!m_is_quiet) {
+                    print_statistics(std::cout);
+                }
+                m_step_type = StepThroughType::NO_MORE_STEPS;
+            }
+        }
         break;
     case StepThroughType::NO_MORE_STEPS:
         break;
     }
 }
 
+void Application::apply_trace_state()
+{
+    const std::vector<Vector2>& found_obstacles = m_trace_reader->get_found_obstacles();
+
+    m_robots[0].position = m_trace_reader->get_position();
+    m_robots[0].orientation = m_trace_reader->get_orientation();
+    m_number_of_iterations = m_trace_reader->get_iteration();
+
+    // Seeking back forgets the obstacles found since
+    if (found_obstacles.size() < m_found_obstacles.size()) {
+        for (std::size_t i = found_obstacles.size(); i < m_found_obstacles.size(); i++) {
+            m_found_obstacle_grid.set_occupied(m_found_obstacles[i], false);
+        }
+        m_found_obstacles.resize(found_obstacles.size());
+        m_plot_version++;
+    }
+    for (std::size_t i = m_found_obstacles.size(); i < found_obstacles.size(); i++) {
+        add_found_obstacle(found_obstacles[i]);
+    }
+}
+
+void Application::add_algorithm(std::string name, AlgorithmState* (*create_state)(),
+                                void (*run_headless)(Application&, int max_iterations))
+{
+    Algorithm alg = {name, create_state, run_headless};
+    m_algorithms.push_back(alg);
+}
+
+void Application::print_algorithms()
+{
+    for (const Algorithm& alg : m_algorithms) {
+        std::cout << alg.name << std::endl;
+    }
+}
+
+void Application::step_through()
+{
+    if (m_trace_reader != nullptr) {
+        replay_step();
+    } else if (m_step_type == StepThroughType::NO_MORE_STEPS) {
+        return;
+    } else if (m_robots.size() > 1) {
+        step_through_fleet();
+    } else {
+        step_through(*m_algorithm_states[0]);
+    }
+}
+
+void Application::run_headless(int max_iterations)
+{
+    if (m_robots.size() > 1) {
+        while (m_step_type != StepThroughType::NO_MORE_STEPS &&
+               (max_iterations == 0 || m_number_of_iterations < max_iterations)) {
+            step_through_fleet();
+        }
+    } else if (m_run_headless != nullptr) {
+        m_run_headless(*this, max_iterations);
+    } else {
+        run_headless_steps<AlgorithmState>(max_iterations);
+    }
+}
+
 bool Application::has_stopped()
 {
     return m_step_type == StepThroughType::NO_MORE_STEPS;
 }
 
+bool Application::is_replaying()
+{
+    return m_trace_reader != nullptr;
+}
+
+// Seeking never prints the statistics, only stepping to the end does
+void Application::seek(int iteration)
+{
+    if (m_trace_reader == nullptr) {
+        return;
+    }
+
+    if (m_step_type == StepThroughType::FIRST_STEP) {
+        generate_world();
+    }
+    m_trace_reader->seek(std::max(iteration, 0));
+    apply_trace_state();
+    if (m_trace_reader->has_next()) {
+        m_step_type = StepThroughType::REGULAR_STEP;
+    } else {
+        m_step_type = StepThroughType::NO_MORE_STEPS;
+    }
+}
+
+void Application::restart(unsigned long long seed)
+{
+    // Applications with invalid parameters never run
+    if (!m_algorithm_states.empty()) {
+        m_obstacles.clear();
+        m_found_obstacles.clear();
+        m_seen_spaces.clear();
+        m_planned_path.clear();
+        m_plot_version++;
+        m_path_version++;
+        m_number_of_iterations = 0;
+        for (std::unique_ptr<AlgorithmState>& state : m_algorithm_states) {
+            state->reset();
+        }
+        reset_robots(seed);
+        m_step_type = StepThroughType::FIRST_STEP;
+    }
+}
+
+// Robots sense and plan in parallel, since they only read the world and the
+// plotted map, which no robot changes before acting. They then act and plot
+// one after another in robot order, so that robots heading for the same
+// space always resolve the same way.
+void Application::step_through_fleet()
+{
+    if (m_step_type == StepThroughType::FIRST_STEP) {
+        generate_world();
+        m_step_type = StepThroughType::REGULAR_STEP;
+    }
+
+    run_fleet_phase(SENSE_PHASE);
+    run_fleet_phase(PLAN_PHASE);
+
+    std::chrono::steady_clock::time_point start = start_phase();
+    for (std::size_t i = 0; i < m_robots.size(); i++) {
+        if (!m_robots[i].has_stopped) {
+            m_algorithm_states[i]->act(*m_servers[i]);
+        }
+    }
+    end_phase(ACT_PHASE, start);
+
+    start = start_phase();
+    for (std::size_t i = 0; i < m_robots.size(); i++) {
+        m_algorithm_states[i]->plot(*m_servers[i], *m_plotters[i]);
+    }
+    end_phase(PLOT_PHASE, start);
+
+    m_number_of_iterations++;
+
+    // The fleet is done once every robot has stopped, or once the robots have
+    // found every obstacle between them
+    bool has_every_robot_stopped = true;
+    for (const Robot& robot : m_robots) {
+        has_every_robot_stopped = has_every_robot_stopped && robot.has_stopped;
+    }
+    if (has_every_robot_stopped || m_found_obstacles.size() == m_obstacle_amount) {
+        if (!m_is_quiet) {
+            print_statistics(std::cout);
+        }
+        m_step_type = StepThroughType::NO_MORE_STEPS;
+    }
+}
+
+void Application::run_fleet_phase(Phase phase)
+{
+    std::chrono::steady_clock::time_point start = start_phase();
+
+    // Robots run one after the other are called directly, as wrapping them
+    // in a task would allocate on every step
+    for (int i = 0; i < m_robots.size(); i++) {
+        if (!m_robots[i].has_stopped) {
+            if (m_robot_pool != nullptr) {
+                m_robot_pool->add_task([this, i, phase]() {
+                    run_robot_phase(i, phase);
+                });
+            } else {
+                run_robot_phase(i, phase);
+            }
+        }
+    }
+    if (m_robot_pool != nullptr) {
+        m_robot_pool->wait();
+    }
+
+    end_phase(phase, start);
+}
+
+void Application::run_robot_phase(int robot, Phase phase)
+{
+    if (phase == SENSE_PHASE) {
+        m_algorithm_states[robot]->sense(*m_servers[robot]);
+    } else {
+        m_algorithm_states[robot]->plan(*m_servers[robot]);
+    }
+}
+
+void Application::set_quiet(bool is_quiet)
+{
+    m_is_quiet = is_quiet;
+}
+
+void Application::set_parallel(bool is_parallel)
+{
+    m_is_parallel = is_parallel;
+    create_robot_pool();
+}
+
+// Picks obstacle_amount distinct cells uniformly at random, never a start
+// cell. Cells are numbered row-major, so the start cells of k robots are cells
+// 0 to k - 1 and the candidates the cells from k on. Sparse worlds use Floyd's
+// algorithm with the world grid as the set of chosen cells, dense worlds a
+// partial Fisher-Yates shuffle, so both take time linear in the amount of
+// obstacles.
 void Application::generate_random_obstacles()
 {
+    int start_cell_amount = m_robots.size();
+    long long candidate_amount = static_cast<long long>(m_grid_width) * m_grid_height - start_cell_amount;
+
+    m_obstacles.clear();
     m_obstacles.reserve(m_obstacle_amount);
-    // Seed random number generator
-    std::srand(std::time(nullptr));
-    // Generate random obstacles
-    for (int i = 0; i < m_obstacle_amount; i++) {
-        int x = 0;
-        int y = 0;
-        // Do not put an obstacle at the origin
-        while (x == 0 && y == 0) {
-            x = std::rand() % m_grid_width;
-            y = std::rand() % m_grid_height;
-            // Make sure x and y are not already an obstacle
-            for (int i = 0; i < m_obstacles.size() && !(x == 0 && y == 0); i++) {
-                if (Vector2(x, y) == m_obstacles[i]) {
-                    x = 0;
-                    y = 0;
-                }
+    m_world.reset(m_grid_width, m_grid_height);
+
+    if (m_obstacle_amount <= candidate_amount / 2) {
+        for (long long j = candidate_amount - m_obstacle_amount; j < candidate_amount; j++) {
+            long long cell = m_random.next_below(j + 1) + start_cell_amount;
+            Vector2 position(cell % m_grid_width, cell / m_grid_width);
+            // If the cell was already chosen, choose the last candidate cell
+            // so far instead, which cannot have been chosen yet
+            if (m_world.is_occupied(position)) {
+                cell = j + start_cell_amount;
+                position = Vector2(cell % m_grid_width, cell / m_grid_width);
             }
+            m_obstacles.push_back(position);
+            m_world.set_occupied(position, true);
+        }
+    } else {
+        std::vector<long long> cells(candidate_amount);
+        for (long long i = 0; i < candidate_amount; i++) {
+            cells[i] = i + start_cell_amount;
+        }
+        for (int i = 0; i < m_obstacle_amount; i++) {
+            long long j = i + m_random.next_below(candidate_amount - i);
+            std::swap(cells[i], cells[j]);
+            Vector2 position(cells[i] % m_grid_width, cells[i] / m_grid_width);
+            m_obstacles.push_back(position);
+            m_world.set_occupied(position, true);
         }
-        m_obstacles.push_back(Vector2(x, y));
     }
 }
 
-void Application::run_algorithm_once()
+void Application::print_statistics(std::ostream& stream)
 {
-    int alg_index;
-    bool found_alg = false;
+    stream << std::endl;
+    stream << "Number of iterations: " << m_number_of_iterations << std::endl;
 
-    // Search for alg
-    for (int i = 0; i < m_algorithms.size() && !found_alg; i++) {
-        if (m_algorithms[i].name == m_algorithm_name) {
-            alg_index = i;
-            found_alg = true;
+    // Replays have no algorithm state, and fleets report every robot's
+    if (m_algorithm_states.size() == 1) {
+        m_algorithm_states[0]->report(stream);
+    } else if (m_algorithm_states.size() > 1) {
+        stream << "Number of robots: " << m_algorithm_states.size() << std::endl;
+        for (std::size_t i = 0; i < m_algorithm_states.size(); i++) {
+            std::ostringstream report;
+            m_algorithm_states[i]->report(report);
+            if (!report.str().empty()) {
+                stream << "Robot " << i << ":" << std::endl << report.str();
+            }
         }
     }
+    if (m_is_profiling) {
+        m_profile.print(stream);
+    }
+}
 
-    if (m_algorithms[alg_index].sense != nullptr && m_step_type != LAST_STEP) {
-        m_algorithms[alg_index].sense(m_server);
+// The clock is only read when profiling, so timing costs a branch otherwise
+std::chrono::steady_clock::time_point Application::start_phase()
+{
+    if (m_is_profiling) {
+        return std::chrono::steady_clock::now();
     }
-    if (m_algorithms[alg_index].plan != nullptr && m_step_type != LAST_STEP) {
-        m_algorithms[alg_index].plan(m_server);
+    return std::chrono::steady_clock::time_point();
+}
+
+void Application::end_phase(Phase phase, std::chrono::steady_clock::time_point start)
+{
+    if (m_is_profiling) {
+        std::chrono::nanoseconds duration = std::chrono::steady_clock::now() - start;
+        m_profile.add(phase, duration.count());
     }
-    if (m_algorithms[alg_index].act != nullptr && m_step_type != LAST_STEP) {
-        m_algorithms[alg_index].act(m_server);
+}
+
+void Application::add_found_obstacle(Vector2 obstacle)
+{
+    if (!m_found_obstacle_grid.is_occupied(obstacle)) {
+        m_found_obstacle_grid.set_occupied(obstacle, true);
+        m_found_obstacles.push_back(obstacle);
+        m_plot_version++;
     }
-    if (m_algorithms[alg_index].plot != nullptr) {
-        m_algorithms[alg_index].plot(m_server, m_plotter);
+}
+
+void Application::add_seen_space(Vector2 space)
+{
+    Vector2 grid_position = space + Vector2(1, 1);
+    if (!m_seen_space_grid.is_occupied(grid_position)) {
+        m_seen_space_grid.set_occupied(grid_position, true);
+        m_seen_spaces.push_back(space);
+        m_plot_version++;
     }
+}
 
-    // Add one to the number of iterations
-    m_number_of_iterations++;
+void Application::set_planned_path(const std::vector<Vector2>& path)
+{
+    m_planned_path = path;
+    m_plot_version++;
+    m_path_version++;
+}
 
-    // Print number of iterations if last step
-    if (m_step_type == LAST_STEP) {
-        std::cout << std::endl;
-        std::cout << "Number of iterations: " << m_number_of_iterations << std::endl;
-        m_step_type = NO_MORE_STEPS;
-    }
+Vector2 Application::get_robot_position(int robot)
+{
+    return m_robots[robot].position;
 }
 
-void Application::set_found_obstacles(const std::vector<Vector2>& obstacles)
+int Application::get_robot_orientation(int robot)
 {
-    m_found_obstacles = obstacles;
+    return m_robots[robot].orientation;
 }
 
-Vector2 Application::get_robot_position()
+int Application::get_robot_amount()
 {
-    return m_robot_position;
+    return m_robots.size();
 }
 
-int Application::get_robot_orientation()
+const std::vector<Robot>& Application::get_robots()
 {
-    return m_robot_orientation;
+    return m_robots;
+}
+
+bool Application::is_other_robot_at(Vector2 position, int robot)
+{
+    for (int i = 0; i < m_robots.size(); i++) {
+        if (m_robots[i].position == position && i != robot && !m_robots[i].has_stopped) {
+            return true;
+        }
+    }
+    return false;
 }
 
 int Application::get_number_of_iterations()
@@ -171,6 +659,10 @@ int Application::get_number_of_iterations()
 
 const std::vector<Vector2>& Application::get_obstacles()
 {
+    if (m_has_map && m_obstacles.empty()) {
+        m_obstacles.reserve(m_obstacle_amount);
+        m_world.append_occupied_cells(m_obstacles);
+    }
     return m_obstacles;
 }
 
@@ -179,6 +671,26 @@ const std::vector<Vector2>& Application::get_found_obstacles()
     return m_found_obstacles;
 }
 
+const std::vector<Vector2>& Application::get_seen_spaces()
+{
+    return m_seen_spaces;
+}
+
+const std::vector<Vector2>& Application::get_planned_path()
+{
+    return m_planned_path;
+}
+
+unsigned long long Application::get_plot_version()
+{
+    return m_plot_version;
+}
+
+unsigned long long Application::get_path_version()
+{
+    return m_path_version;
+}
+
 int Application::get_grid_width()
 {
     return m_grid_width;
@@ -194,17 +706,60 @@ int Application::get_obstacle_amount()
     return m_obstacle_amount;
 }
 
-void Application::set_robot_position(Vector2 position)
+bool Application::is_obstacle(Vector2 position)
+{
+    return m_world.is_occupied(position);
+}
+
+bool Application::is_found_obstacle(Vector2 position)
+{
+    return m_found_obstacle_grid.is_occupied(position);
+}
+
+bool Application::is_in_grid(Vector2 position)
+{
+    return m_world.is_in_bounds(position);
+}
+
+void Application::scan(SensorScan& scan, int robot)
 {
-    m_robot_position = position;
+    m_sensor.scan(m_world, m_robots[robot].position, m_robots[robot].orientation, scan);
 }
 
-void Application::set_robot_orientation(int orientation)
+RobotServer& Application::get_robot_server(int robot)
 {
-    m_robot_orientation = orientation;
+    return *m_servers[robot];
 }
 
-void Application::stop()
+RandomGenerator& Application::get_random_generator(int robot)
 {
-    m_step_type = StepThroughType::LAST_STEP;
+    if (robot == 0) {
+        return m_random;
+    }
+    return m_robot_randoms[robot - 1];
+}
+
+const PhaseProfile& Application::get_profile()
+{
+    return m_profile;
+}
+
+void Application::set_robot_position(Vector2 position, int robot)
+{
+    m_robots[robot].position = position;
+}
+
+void Application::set_robot_orientation(int orientation, int robot)
+{
+    m_robots[robot].orientation = orientation;
+}
+
+// Robots of a fleet may stop while sensing and planning in parallel, so they
+// only ever change their own data here
+void Application::stop(int robot)
+{
+    m_robots[robot].has_stopped = true;
+    if (m_robots.size() == 1) {
+        m_step_type = StepThroughType::LAST_STEP;
+    }
 }
@@ -4,24 +4,76 @@
 #define APPLICATION_H
 
 // Includes
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <ostream>
 #include <string>
 #include "data_types.h"
+#include "occupancy_grid.h"
+#include "phase_profile.h"
+#include "random_generator.h"
+#include "range_sensor.h"
 #include "robot_server.h"
 #include "plotter.h"
+#include "thread_pool.h"
+#include "trace.h"
+#include "mapped_file.h"
 
 struct Parameters {
     int grid_width;
     int grid_height;
     int obstacle_amount;
     std::string algorithm;
+    unsigned long long seed;
+    // Whether to time the phases of every step
+    bool is_profiling;
+    // A file to record the run to, and a recorded run to replay instead of
+    // running an algorithm. Unused if empty.
+    std::string record_file;
+    std::string replay_file;
+    // A map to load the world from rather than generating it, and a file to
+    // save the world to once it exists. Unused if empty.
+    std::string map_file;
+    std::string save_map_file;
+    // The amount of robots, which all share what they find
+    int robot_amount;
+    // What the robots' scans see, see range_sensor.h
+    SensorModel sensor_model;
 };
 
+// The state of an algorithm during a single run. Every application creates
+// its own, so several applications can run at the same time.
+class AlgorithmState {
+public:
+    virtual ~AlgorithmState();
+    // Prepares the state for a new run, keeping allocations where possible
+    virtual void reset() = 0;
+    virtual void sense(RobotServer&) = 0;
+    virtual void plan(RobotServer&) = 0;
+    virtual void act(RobotServer&) = 0;
+    virtual void plot(RobotServer&, Plotter&) = 0;
+    // Prints algorithm specific statistics at the end of a run
+    virtual void report(std::ostream&);
+};
+
+class Application;
+
 struct Algorithm {
     std::string name;
-    void (*sense)(RobotServer&);
-    void (*plan)(RobotServer&);
-    void (*act)(RobotServer&);
-    void (*plot)(RobotServer&, Plotter&);
+    AlgorithmState* (*create_state)();
+    // Runs the application without a UI with the algorithm's calls
+    // dispatched statically, see run_headless below. May be null.
+    void (*run_headless)(Application&, int max_iterations);
+};
+
+// A robot of the simulation. Every robot has its own server, plotter and
+// algorithm state, while the world and the plotted map are shared.
+struct Robot {
+    Vector2 position;
+    int orientation;
+    // Whether the robot's algorithm has stopped it
+    bool has_stopped;
 };
 
 enum StepThroughType {
@@ -38,52 +90,241 @@ private:
     int m_grid_height;
     int m_obstacle_amount;
     std::string m_algorithm_name;
-    // Robot position and orientation
-    Vector2 m_robot_position;
-    int m_robot_orientation;
-    // Obstacle positions
+    // The robots, robot zero first. Single robot runs only have robot zero.
+    std::vector<Robot> m_robots;
+    // Obstacle positions. Worlds loaded from maps only list them when asked
+    // to, as large maps have more obstacles than are worth listing.
     std::vector<Vector2> m_obstacles;
+    // What the algorithms have plotted. Found obstacles and seen spaces are
+    // only ever added to during a run, and the plot version is increased on
+    // every change, so UIs only have to look at what is new. The grids keep
+    // robots from plotting the same space twice; the seen grid has a border
+    // of one cell, since robots also see the spaces just outside the world.
     std::vector<Vector2> m_found_obstacles;
-    // Algorithms
+    std::vector<Vector2> m_seen_spaces;
+    OccupancyGrid m_found_obstacle_grid;
+    OccupancyGrid m_seen_space_grid;
+    std::vector<Vector2> m_planned_path;
+    unsigned long long m_plot_version;
+    unsigned long long m_path_version;
+    // Ground truth world, used for O(1) obstacle queries. With a binary map
+    // it is a view of the mapped file.
+    OccupancyGrid m_world;
+    RangeSensor m_sensor;
+    bool m_has_map;
+    MappedFile m_map_file;
+    std::string m_save_map_file;
+    // Random numbers for both the world and robot zero's algorithm, and for
+    // the algorithms of the other robots
+    RandomGenerator m_random;
+    std::vector<RandomGenerator> m_robot_randoms;
+    // Algorithms, one state per robot
     std::vector<Algorithm> m_algorithms;
-    // Helper objects
-    RobotServer m_server;
-    Plotter m_plotter;
+    std::vector<std::unique_ptr<AlgorithmState>> m_algorithm_states;
+    void (*m_run_headless)(Application&, int max_iterations);
+    // Helper objects, one of each per robot
+    std::vector<std::unique_ptr<RobotServer>> m_servers;
+    std::vector<std::unique_ptr<Plotter>> m_plotters;
+    // Whether the robots of a fleet should run in parallel
+    bool m_is_parallel;
+    // Runs the robots of a fleet in parallel, null if they run one after the
+    // other
+    std::unique_ptr<ThreadPool> m_robot_pool;
     // Additional data members
     StepThroughType m_step_type;
     int m_number_of_iterations;
+    bool m_is_quiet;
+    // Phase timings, only collected when profiling
+    bool m_is_profiling;
+    PhaseProfile m_profile;
+    // Recording and replaying, see trace.h
+    std::unique_ptr<TraceWriter> m_trace_writer;
+    std::unique_ptr<TraceReader> m_trace_reader;
     // Private member function for running the algorithm
     void process_parameters(const Parameters&);
-    void generate_random_obstacles();
-    void run_algorithm_once();
+    void create_robots(int robot_amount);
+    void create_robot_pool();
+    Vector2 calculate_start_position(int robot);
+    bool are_start_cells_free(int robot_amount);
+    void reset_robots(unsigned long long seed);
+    bool open_map(const std::string& path);
+    void generate_world();
+    void start_recording(const Parameters&);
+    void record_step();
+    void start_replay(const Parameters&);
+    void replay_step();
+    void apply_trace_state();
+    // The step functions are templates so that the statically dispatched
+    // runs share them. With AlgorithmState as the state type the algorithm is
+    // called through its virtual functions.
+    template <class State> void step_through(State&);
+    template <class State> void run_algorithm_once(State&);
+    void step_through_fleet();
+    void run_fleet_phase(Phase);
+    void run_robot_phase(int robot, Phase);
+    std::chrono::steady_clock::time_point start_phase();
+    void end_phase(Phase, std::chrono::steady_clock::time_point start);
 public:
     Application(const Parameters& parameters);
-    void add_algorithm(std::string name, void (*sense)(RobotServer&),
-                       void (*plan)(RobotServer&), void (*act)(RobotServer&),
-                       void (*plot)(RobotServer&, Plotter&));
+    void add_algorithm(std::string name, AlgorithmState* (*create_state)(),
+                       void (*run_headless)(Application&, int max_iterations) = nullptr);
     void print_algorithms();
     void step_through();
+    // Steps until the run stops or max_iterations iterations have been taken,
+    // where zero means no limit. Single robot runs use the algorithm's
+    // statically dispatched runner if it was registered with one.
+    void run_headless(int max_iterations);
+    // The same with the algorithm's calls resolved at compile time, so that
+    // they can be inlined. State must be the type of the algorithm state, and
+    // only robot zero is run.
+    template <class State> void run_headless_steps(int max_iterations);
     bool has_stopped();
+    // Whether the application replays a recorded run
+    bool is_replaying();
+    // Moves a replay to the state after the given amount of iterations
+    void seek(int iteration);
+    // Starts a new run with a new world generated from the seed, reusing the
+    // algorithm state
+    void restart(unsigned long long seed);
+    // Called by the first step unless the world is loaded from a map, public
+    // so that worlds can be generated and driven without running the chosen
+    // algorithm
+    void generate_random_obstacles();
+    RobotServer& get_robot_server(int robot = 0);
+    // A quiet application does not print the number of iterations at the end
+    void set_quiet(bool);
+    // Whether the robots of a fleet sense and plan on threads of their own,
+    // which they do unless turned off
+    void set_parallel(bool);
+    // Prints the number of iterations and the algorithm's statistics, which
+    // is done at the end of a run unless the application is quiet
+    void print_statistics(std::ostream&);
 
-    // Member function for Plotter
-    void set_found_obstacles(const std::vector<Vector2>&);
+    // Member functions for Plotter. Spaces already plotted are ignored, and
+    // only robot zero's path is kept.
+    void add_found_obstacle(Vector2);
+    void add_seen_space(Vector2);
+    void set_planned_path(const std::vector<Vector2>&);
 
     // Useful getters
-    Vector2 get_robot_position();
-    int get_robot_orientation();
+    Vector2 get_robot_position(int robot = 0);
+    int get_robot_orientation(int robot = 0);
+    int get_robot_amount();
+    const std::vector<Robot>& get_robots();
+    // Whether a robot other than the given one is at the position. Robots
+    // that have stopped are parked and no longer in the way.
+    bool is_other_robot_at(Vector2, int robot);
     int get_number_of_iterations();
     const std::vector<Vector2>& get_obstacles();
     const std::vector<Vector2>& get_found_obstacles();
+    const std::vector<Vector2>& get_seen_spaces();
+    const std::vector<Vector2>& get_planned_path();
+    unsigned long long get_plot_version();
+    // Only increased when the planned path changes
+    unsigned long long get_path_version();
     int get_grid_width();
     int get_grid_height();
     int get_obstacle_amount();
+    bool is_obstacle(Vector2);
+    // Whether the obstacle has been plotted, in O(1)
+    bool is_found_obstacle(Vector2);
+    bool is_in_grid(Vector2);
+    // Fills the scan with what the robot's range sensor senses
+    void scan(SensorScan&, int robot = 0);
+    RandomGenerator& get_random_generator(int robot = 0);
+    // The phase timings of every run since the application was made
+    const PhaseProfile& get_profile();
 
     // Useful setters
-    void set_robot_position(Vector2);
-    void set_robot_orientation(int);
+    void set_robot_position(Vector2, int robot = 0);
+    void set_robot_orientation(int, int robot = 0);
 
-    // Member function for Robot sim server
-    void stop();
+    // Member function for Robot sim server. A single robot stops the run, a
+    // fleet only stops once all of its robots have.
+    void stop(int robot = 0);
 };
 
+// Registered by algorithms along with their state factory to get a
+// statically dispatched headless run, for example
+// app.add_algorithm("name", create_state, run_headless<NameAlgorithm>).
+// The state class should be final, otherwise the compiler must still call
+// through its virtual functions.
+template <class State>
+void run_headless(Application& app, int max_iterations)
+{
+    app.run_headless_steps<State>(max_iterations);
+}
+
+template <class State>
+void Application::run_headless_steps(int max_iterations)
+{
+    // Applications with invalid parameters never run
+    if (m_algorithm_states.empty()) {
+        return;
+    }
+
+    State& state = static_cast<State&>(*m_algorithm_states[0]);
+    while (m_step_type != StepThroughType::NO_MORE_STEPS &&
+           (max_iterations == 0 || m_number_of_iterations < max_iterations)) {
+        step_through(state);
+    }
+}
+
+template <class State>
+void Application::step_through(State& state)
+{
+    switch (m_step_type) {
+    case StepThroughType::FIRST_STEP:
+        generate_world();
+        m_step_type = StepThroughType::REGULAR_STEP;
+    case StepThroughType::LAST_STEP:
+    case StepThroughType::REGULAR_STEP:
+        run_algorithm_once(state);
+        break;
+    case StepThroughType::NO_MORE_STEPS:
+        break;
+    }
+}
+
+template <class State>
+void Application::run_algorithm_once(State& state)
+{
+    std::chrono::steady_clock::time_point start;
+    RobotServer& server = *m_servers[0];
+
+    if (m_step_type != LAST_STEP) {
+        start = start_phase();
+        state.sense(server);
+        end_phase(SENSE_PHASE, start);
+    }
+    if (m_step_type != LAST_STEP) {
+        start = start_phase();
+        state.plan(server);
+        end_phase(PLAN_PHASE, start);
+    }
+    if (m_step_type != LAST_STEP) {
+        start = start_phase();
+        state.act(server);
+        end_phase(ACT_PHASE, start);
+    }
+    start = start_phase();
+    state.plot(server, *m_plotters[0]);
+    end_phase(PLOT_PHASE, start);
+
+    // Add one to the number of iterations
+    m_number_of_iterations++;
+
+    if (m_trace_writer != nullptr) {
+        record_step();
+    }
+
+    // Print number of iterations if last step
+    if (m_step_type == LAST_STEP) {
+        if (!m_is_quiet) {
+            print_statistics(std::cout);
+        }
+        m_step_type = NO_MORE_STEPS;
+    }
+}
+
 #endif
@@ -0,0 +1,141 @@
+// Includes
+#include "batch_runner.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+// Local types
+struct TrialResult {
+    int iterations;
+    double milliseconds;
+    bool has_completed;
+};
+
+// Local function prototypes
+static void run_trials(const Parameters&, const BatchParameters&,
+                       std::atomic<int>& next_trial, std::vector<TrialResult>& results,
+                       std::mutex& profile_mutex, PhaseProfile& profile);
+static TrialResult run_trial(Application&, int max_iterations);
+static void print_statistics(const char* name, std::vector<double> values);
+
+int run_batch(const Parameters& parameters, const BatchParameters& batch_parameters)
+{
+    if (!parameters.record_file.empty()) {
+        std::cerr << "Recording is not supported in batch mode." << std::endl;
+        return 1;
+    }
+    if (!parameters.replay_file.empty()) {
+        std::cerr << "Replaying is not supported in batch mode." << std::endl;
+        return 1;
+    }
+    if (!parameters.save_map_file.empty()) {
+        std::cerr << "Saving maps is not supported in batch mode." << std::endl;
+        return 1;
+    }
+
+    // Check the parameters once rather than once per trial
+    {
+        Application app(parameters);
+        if (app.has_stopped()) {
+            return 1;
+        }
+    }
+
+    if (batch_parameters.trial_amount < 1) {
+        std::cerr << "Trial amount is too small." << std::endl;
+        return 1;
+    }
+
+    std::vector<TrialResult> results(batch_parameters.trial_amount);
+    std::atomic<int> next_trial(0);
+    std::mutex profile_mutex;
+    PhaseProfile profile;
+    ThreadPool pool(batch_parameters.thread_amount);
+
+    // One task per thread, each reusing its application for many trials
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < pool.get_thread_amount(); i++) {
+        pool.add_task([&]() {
+            run_trials(parameters, batch_parameters, next_trial, results, profile_mutex, profile);
+        });
+    }
+    pool.wait();
+    std::chrono::duration<double> wall_time = std::chrono::steady_clock::now() - start;
+
+    std::vector<double> iterations;
+    std::vector<double> milliseconds;
+    int completed_trial_amount = 0;
+    for (const TrialResult& result : results) {
+        iterations.push_back(result.iterations);
+        milliseconds.push_back(result.milliseconds);
+        if (result.has_completed) {
+            completed_trial_amount++;
+        }
+    }
+
+    std::cout << "Trials:            " << batch_parameters.trial_amount
+              << " on " << pool.get_thread_amount() << " threads" << std::endl;
+    std::cout << "Completed trials:  " << completed_trial_amount << std::endl;
+    print_statistics("Iterations:        ", iterations);
+    print_statistics("Trial time (ms):   ", milliseconds);
+    std::cout << "Wall-clock time:   " << wall_time.count() << " s" << std::endl;
+    if (parameters.is_profiling) {
+        profile.print(std::cout);
+    }
+    return 0;
+}
+
+void run_trials(const Parameters& parameters, const BatchParameters& batch_parameters,
+                std::atomic<int>& next_trial, std::vector<TrialResult>& results,
+                std::mutex& profile_mutex, PhaseProfile& profile)
+{
+    Application app(parameters);
+    app.set_quiet(true);
+    // The trials already keep every core busy
+    app.set_parallel(false);
+
+    // Every trial has its own seed, so any trial can be replayed with -seed
+    int trial = next_trial++;
+    while (trial < batch_parameters.trial_amount) {
+        app.restart(parameters.seed + trial);
+        results[trial] = run_trial(app, batch_parameters.max_iterations);
+        trial = next_trial++;
+    }
+
+    // The application's profile covers all of its trials
+    std::lock_guard<std::mutex> lock(profile_mutex);
+    profile.merge(app.get_profile());
+}
+
+TrialResult run_trial(Application& app, int max_iterations)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    app.run_headless(max_iterations);
+
+    std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+    TrialResult result = {app.get_number_of_iterations(), time.count(), app.has_stopped()};
+    return result;
+}
+
+void print_statistics(const char* name, std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+
+    double sum = 0;
+    for (double value : values) {
+        sum += value;
+    }
+
+    // Nearest rank percentiles
+    int size = values.size();
+    double median = values[(size - 1) / 2];
+    double p95 = values[std::min(size - 1, (size * 95 + 99) / 100 - 1)];
+
+    std::cout << name << "mean " << sum / size << ", median " << median
+              << ", p95 " << p95 << ", max " << values.back() << std::endl;
+}
@@ -0,0 +1,23 @@
+// Begin header guard
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+// Includes
+#include "application.h"
+
+struct BatchParameters {
+    int trial_amount;
+    // Trials still running after this many iterations are cut off, zero
+    // means no limit
+    int max_iterations;
+    // Zero means one thread per core
+    int thread_amount;
+};
+
+// Runs independent simulations without a UI on a thread pool and prints
+// statistics about the amount of iterations and time per trial. Trial n uses
+// the seed of the parameters plus n.
+int run_batch(const Parameters&, const BatchParameters&);
+
+// End header guard
+#endif
@@ -1,73 +1,238 @@
-
 // Includes
 #include "console_ui.h"
+#include <algorithm>
+#include <cstdio>
 #include <iostream>
+#include <utility>
+#ifdef _WIN32
+#define NOMINMAX
+#include <io.h>
+#include <windows.h>
+#else
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+// Local constants
+// Indexed by orientation
+static const char ROBOT_CHARACTERS[4] = {'^', '<', 'v', '>'};
 
-ConsoleUI::ConsoleUI(const Parameters& parameters) : m_app(parameters)
+// Local function prototypes
+static bool get_terminal_size(int& columns, int& rows);
+static int follow_robot(int robot, int origin, int size, int grid_size);
+static void append_number(std::string&, int);
+
+ConsoleUI::ConsoleUI(const Parameters& parameters, const ConsoleOptions& options)
+    : m_app(parameters), m_options(options), m_viewport_origin(0, 0),
+      m_viewport_width(0), m_viewport_height(0)
 {
+    // In diff mode the cursor is moved back into the frame, so the statistics
+    // are printed by the UI after the final frame rather than by the
+    // application during the last step
+    m_app.set_quiet(m_options.is_diff_rendering);
+
+#ifdef _WIN32
+    // Windows consoles only understand escape codes when asked to
+    if (m_options.is_diff_rendering) {
+        HANDLE output = GetStdHandle(STD_OUTPUT_HANDLE);
+        DWORD mode;
+        if (GetConsoleMode(output, &mode)) {
+            SetConsoleMode(output, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+        }
+    }
+#endif
 }
 
 int ConsoleUI::run_loop()
 {
+    if (m_options.render_every < 1) {
+        std::cerr << "Render interval is too small." << std::endl;
+        return 1;
+    }
+
     while (!m_app.has_stopped()) {
         m_app.step_through();
-        print_robot_and_obstacles();
+        if (should_render()) {
+            print_robot_and_obstacles();
+        }
+    }
+
+    if (m_options.is_diff_rendering && m_app.get_number_of_iterations() > 0) {
+        m_app.print_statistics(std::cout);
     }
     return 0;
 }
 
-void ConsoleUI::print_robot_and_obstacles()
+bool ConsoleUI::should_render()
 {
-    using std::cout;
-    using std::endl;
-    using std::vector;
+    return m_app.get_number_of_iterations() % m_options.render_every == 0 || m_app.has_stopped();
+}
 
-    vector<vector<char>> grid;
+void ConsoleUI::update_viewport()
+{
+    int grid_width = m_app.get_grid_width();
+    int grid_height = m_app.get_grid_height();
+    int columns;
+    int rows;
 
-    for (int i = 0; i < m_app.get_grid_width(); i++) {
-        grid.push_back(vector<char>());
-        for (int j = 0; j < m_app.get_grid_height(); j++) {
-            grid[i].push_back(' ');
-        }
+    // Leave room for the border and the line the cursor rests on. Output that
+    // is not a terminal gets the whole grid.
+    if (get_terminal_size(columns, rows)) {
+        m_viewport_width = std::max(1, std::min(grid_width, columns - 2));
+        m_viewport_height = std::max(1, std::min(grid_height, rows - 3));
+    } else {
+        m_viewport_width = grid_width;
+        m_viewport_height = grid_height;
     }
 
     Vector2 position = m_app.get_robot_position();
-    switch (m_app.get_robot_orientation()) {
-    case 0:
-        grid[position.x][position.y] = '^';
-        break;
-    case 1:
-        grid[position.x][position.y] = '<';
-        break;
-    case 2:
-        grid[position.x][position.y] = 'v';
-        break;
-    case 3:
-        grid[position.x][position.y] = '>';
-        break;
+    m_viewport_origin.x = follow_robot(position.x, m_viewport_origin.x, m_viewport_width, grid_width);
+    m_viewport_origin.y = follow_robot(position.y, m_viewport_origin.y, m_viewport_height, grid_height);
+}
+
+void ConsoleUI::fill_cells()
+{
+    int width = m_viewport_width;
+    int height = m_viewport_height;
+
+    m_cells.resize(width * height);
+
+    // Rows are stored from the top, the order they are printed in. Only the
+    // cells of the viewport are looked at, so a frame costs the same however
+    // many obstacles have been found.
+    for (int y = 0; y < height; y++) {
+        char* row = &m_cells[(height - 1 - y) * width];
+        for (int x = 0; x < width; x++) {
+            row[x] = m_app.is_found_obstacle(m_viewport_origin + Vector2(x, y)) ? '*' : ' ';
+        }
     }
 
-    const vector<Vector2>& obstacles = m_app.get_found_obstacles();
-    for (int i = 0; i < obstacles.size(); i++) {
-        grid[obstacles[i].x][obstacles[i].y] = '*';
+    // Obstacles are drawn over robots
+    for (const Robot& robot : m_app.get_robots()) {
+        int x = robot.position.x - m_viewport_origin.x;
+        int y = robot.position.y - m_viewport_origin.y;
+        if (x >= 0 && x < width && y >= 0 && y < height && m_cells[(height - 1 - y) * width + x] == ' ') {
+            m_cells[(height - 1 - y) * width + x] = ROBOT_CHARACTERS[robot.orientation];
+        }
     }
+}
 
-    for (int i = 0; i < m_app.get_grid_width() + 2; i++) {
-        cout << '-';
+void ConsoleUI::append_full_frame()
+{
+    m_output.append(m_viewport_width + 2, '-');
+    m_output += '\n';
+
+    for (int i = 0; i < m_viewport_height; i++) {
+        m_output += '|';
+        m_output.append(m_cells, i * m_viewport_width, m_viewport_width);
+        m_output += "|\n";
     }
-    cout << endl;
 
-    for (int i = 0; i < m_app.get_grid_height(); i++) {
-        cout << '|';
-        for (int j = 0; j < m_app.get_grid_width(); j++) {
-            cout << grid[j][m_app.get_grid_height() - i - 1];
+    m_output.append(m_viewport_width + 2, '-');
+    m_output += '\n';
+}
+
+void ConsoleUI::append_changed_cells()
+{
+    int previous_index = -2;
+
+    for (int i = 0; i < m_cells.size(); i++) {
+        if (m_cells[i] != m_previous_cells[i]) {
+            // The cursor only has to be moved if it is not already there.
+            // Terminal rows and columns start at one, and the cells at the
+            // second of each because of the border.
+            if (i != previous_index + 1 || i % m_viewport_width == 0) {
+                m_output += "\x1b[";
+                append_number(m_output, i / m_viewport_width + 2);
+                m_output += ';';
+                append_number(m_output, i % m_viewport_width + 2);
+                m_output += 'H';
+            }
+            m_output += m_cells[i];
+            previous_index = i;
         }
-        cout << '|';
-        cout << endl;
     }
 
-    for (int i = 0; i < m_app.get_grid_width() + 2; i++) {
-        cout << '-';
+    // Rest the cursor below the frame
+    m_output += "\x1b[";
+    append_number(m_output, m_viewport_height + 3);
+    m_output += ";1H";
+}
+
+void ConsoleUI::print_robot_and_obstacles()
+{
+    Vector2 old_origin = m_viewport_origin;
+    int old_width = m_viewport_width;
+    int old_height = m_viewport_height;
+
+    update_viewport();
+    fill_cells();
+
+    m_output.clear();
+    if (m_options.is_diff_rendering) {
+        bool has_viewport_changed = m_viewport_origin != old_origin ||
+                                    m_viewport_width != old_width ||
+                                    m_viewport_height != old_height;
+        if (m_previous_cells.empty() || has_viewport_changed) {
+            m_output += "\x1b[2J\x1b[H";
+            append_full_frame();
+        } else {
+            append_changed_cells();
+        }
+        std::swap(m_cells, m_previous_cells);
+    } else {
+        append_full_frame();
+    }
+
+    // One write per frame
+    std::cout.write(m_output.data(), m_output.size());
+    std::cout.flush();
+}
+
+bool get_terminal_size(int& columns, int& rows)
+{
+#ifdef _WIN32
+    CONSOLE_SCREEN_BUFFER_INFO info;
+    if (!_isatty(_fileno(stdout)) ||
+        !GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info)) {
+        return false;
+    }
+    columns = info.srWindow.Right - info.srWindow.Left + 1;
+    rows = info.srWindow.Bottom - info.srWindow.Top + 1;
+#else
+    struct winsize size;
+    if (!isatty(STDOUT_FILENO) || ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) != 0 ||
+        size.ws_col == 0 || size.ws_row == 0) {
+        return false;
+    }
+    columns = size.ws_col;
+    rows = size.ws_row;
+#endif
+    return true;
+}
+
+// Moves the viewport along one axis once the robot comes within a quarter of
+// the viewport of its edge, centering it on the robot
+int follow_robot(int robot, int origin, int size, int grid_size)
+{
+    int margin = size / 4;
+    if (robot < origin + margin || robot >= origin + size - margin) {
+        origin = robot - size / 2;
+    }
+    return std::max(0, std::min(origin, grid_size - size));
+}
+
+// Appends a positive number without making a temporary string
+void append_number(std::string& string, int number)
+{
+    char digits[12];
+    int digit_amount = 0;
+    do {
+        digits[digit_amount++] = '0' + number % 10;
+        number /= 10;
+    } while (number > 0);
+
+    while (digit_amount > 0) {
+        string += digits[--digit_amount];
     }
-    cout << endl;
 }
@@ -1,17 +1,43 @@
-
 // Begin header guard
 #ifndef CONSOLE_UI_H
 #define CONSOLE_UI_H
 
 // Includes
 #include "application.h"
+#include <string>
+
+struct ConsoleOptions {
+    // Only every this many steps is drawn, the final state always is
+    int render_every;
+    // Redraw only the cells that changed, using ANSI escape codes to move the
+    // cursor, rather than printing every frame below the last
+    bool is_diff_rendering;
+};
 
 class ConsoleUI {
 private:
     Application m_app;
+    ConsoleOptions m_options;
+    // Bottom left corner of the part of the grid that is shown, which follows
+    // the robot when the grid does not fit in the terminal
+    Vector2 m_viewport_origin;
+    int m_viewport_width;
+    int m_viewport_height;
+    // The shown cells of the current and the last drawn frame, row by row
+    // from the top, and the text written to the terminal. All are kept
+    // between frames so that drawing does not allocate.
+    std::string m_cells;
+    std::string m_previous_cells;
+    std::string m_output;
+    // Helper functions
+    bool should_render();
+    void update_viewport();
+    void fill_cells();
+    void append_full_frame();
+    void append_changed_cells();
     void print_robot_and_obstacles();
 public:
-    ConsoleUI(const Parameters&);
+    ConsoleUI(const Parameters&, const ConsoleOptions&);
     int run_loop();
 };
 
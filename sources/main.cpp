@@ -1,10 +1,16 @@
 
 // Includes
 #include "application.h"
+#include "batch_runner.h"
 #include "console_ui.h"
 #include "sfml_ui.h"
+#include "tournament_runner.h"
+#include <chrono>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <random>
+#include <string>
 #include <vector>
 
 // Local types
@@ -13,6 +19,8 @@ enum class Mode {
     LIST_DEFAULTS,
     LIST_ALGORITHMS,
     RUN,
+    BATCH,
+    TOURNAMENT,
     INVALID_ARGUMENT,
 };
 
@@ -26,41 +34,89 @@ enum class LongOptionWithArgument {
     GRID_HEIGHT,
     OBSTACLE_AMOUNT,
     ALGORITHM,
+    BATCH,
+    MAX_ITERATIONS,
+    THREADS,
+    SEED,
+    RENDER_EVERY,
+    STEPS_PER_SECOND,
+    RECORD,
+    REPLAY,
+    MAP,
+    SAVE_MAP,
+    ROBOTS,
+    SENSOR,
+    SENSOR_RANGE,
+    RAYS,
+    TOURNAMENT,
+    GRID_SIZES,
+    DENSITIES,
+    SEEDS,
+    CSV,
 };
 
 // Global constants (defaults)
-const Parameters DEFAULT_PARAMETERS = {4, 4, 4, "random"};
+// A seed of zero is replaced by a random seed
+const Parameters DEFAULT_PARAMETERS = {4, 4, 4, "random", 0, false, "", "", "", "", 1,
+                                       {SensorType::BEAMS, 1, 360}};
+const BatchParameters DEFAULT_BATCH_PARAMETERS = {1, 0, 0};
+const TournamentParameters DEFAULT_TOURNAMENT_PARAMETERS = {{}, {}, {}, 1, ""};
+const ConsoleOptions DEFAULT_CONSOLE_OPTIONS = {1, false};
+const SFMLOptions DEFAULT_SFML_OPTIONS = {10};
 const Mode DEFAULT_MODE = Mode::RUN;
 
 // Function prototypes
-void parse_arguments(int argc, char* argv[], Parameters&, Mode&, UI&);
+void parse_arguments(int argc, char* argv[], Parameters&, BatchParameters&, TournamentParameters&,
+                     ConsoleOptions&, SFMLOptions&, Mode&, UI&);
 void print_help();
 void print_parameters(const Parameters&);
 int convert_string_to_int(char*);
-int perform_mode(const Parameters&, Mode, UI);
-int run_program(const Parameters&, UI);
+unsigned long long convert_string_to_unsigned_long_long(char*);
+SensorType convert_string_to_sensor_type(char*);
+double convert_string_to_double(char*);
+Vector2 convert_string_to_grid_size(char*);
+std::vector<std::string> split_list(char*);
+unsigned long long generate_seed();
+int perform_mode(const Parameters&, const BatchParameters&, const TournamentParameters&,
+                 const ConsoleOptions&, const SFMLOptions&, Mode, UI);
+int run_program(const Parameters&, const ConsoleOptions&, const SFMLOptions&, UI);
 
 int main(int argc, char* argv[])
 {
     // Set defaults for parameters and mode
     Parameters parameters = DEFAULT_PARAMETERS;
+    BatchParameters batch_parameters = DEFAULT_BATCH_PARAMETERS;
+    TournamentParameters tournament_parameters = DEFAULT_TOURNAMENT_PARAMETERS;
+    ConsoleOptions console_options = DEFAULT_CONSOLE_OPTIONS;
+    SFMLOptions sfml_options = DEFAULT_SFML_OPTIONS;
     Mode mode = Mode::RUN;
     UI ui = UI::SFML;
 
     // Parse command line arguments and change parameters and mode
-    parse_arguments(argc, argv, parameters, mode, ui);
+    parse_arguments(argc, argv, parameters, batch_parameters, tournament_parameters, console_options,
+                    sfml_options, mode, ui);
 
-    // Let the user know how to access help
-    if (mode != Mode::HELP) {
+    // Pick a seed if none was chosen. It is printed with the parameters, so
+    // the run can be repeated with -seed.
+    if (parameters.seed == 0) {
+        parameters.seed = generate_seed();
+    }
+
+    // Let the user know how to access help, unless the output is a table
+    if (mode != Mode::HELP && mode != Mode::TOURNAMENT) {
         std::cout << "Access help with -help" << std::endl;
         std::cout << std::endl;
     }
 
     // Perform mode
-    return perform_mode(parameters, mode, ui);
+    return perform_mode(parameters, batch_parameters, tournament_parameters, console_options,
+                        sfml_options, mode, ui);
 }
 
-int perform_mode(const Parameters& parameters, Mode mode, UI ui)
+int perform_mode(const Parameters& parameters, const BatchParameters& batch_parameters,
+                 const TournamentParameters& tournament_parameters,
+                 const ConsoleOptions& console_options, const SFMLOptions& sfml_options,
+                 Mode mode, UI ui)
 {
     int return_code = 0;
 
@@ -78,8 +134,20 @@ int perform_mode(const Parameters& parameters, Mode mode, UI ui)
         }
         break;
     case Mode::RUN:
+        // A replay's parameters are those of the recorded run
+        if (parameters.replay_file.empty()) {
+            print_parameters(parameters);
+        } else {
+            std::cout << "replaying:       " << parameters.replay_file << std::endl;
+        }
+        return_code = run_program(parameters, console_options, sfml_options, ui);
+        break;
+    case Mode::BATCH:
         print_parameters(parameters);
-        return_code = run_program(parameters, ui);
+        return_code = run_batch(parameters, batch_parameters);
+        break;
+    case Mode::TOURNAMENT:
+        return_code = run_tournament(parameters, batch_parameters, tournament_parameters);
         break;
     case Mode::INVALID_ARGUMENT:
         std::cout << "Error: Invalid argument." << std::endl;
@@ -88,19 +156,20 @@ int perform_mode(const Parameters& parameters, Mode mode, UI ui)
     return return_code;
 }
 
-int run_program(const Parameters& parameters, UI ui)
+int run_program(const Parameters& parameters, const ConsoleOptions& console_options,
+                const SFMLOptions& sfml_options, UI ui)
 {
     int return_code;
     switch (ui) {
     case UI::CONSOLE:
         {
-            ConsoleUI console_ui(parameters);
+            ConsoleUI console_ui(parameters, console_options);
             return_code = console_ui.run_loop();
         }
         break;
     case UI::SFML:
         {
-            SFMLUI sfml_ui(parameters);
+            SFMLUI sfml_ui(parameters, sfml_options);
             return_code = sfml_ui.run_loop();
         }
         break;
@@ -108,7 +177,9 @@ int run_program(const Parameters& parameters, UI ui)
     return return_code;
 }
 
-void parse_arguments(int argc, char* argv[], Parameters& parameters, Mode& mode, UI& ui)
+void parse_arguments(int argc, char* argv[], Parameters& parameters,
+                     BatchParameters& batch_parameters, TournamentParameters& tournament_parameters,
+                     ConsoleOptions& console_options, SFMLOptions& sfml_options, Mode& mode, UI& ui)
 {
     LongOptionWithArgument last_option;
     bool is_argument = false;
@@ -130,6 +201,69 @@ void parse_arguments(int argc, char* argv[], Parameters& parameters, Mode& mode,
             case LongOptionWithArgument::ALGORITHM:
                 parameters.algorithm = argv[i];
                 break;
+            case LongOptionWithArgument::BATCH:
+                batch_parameters.trial_amount = convert_string_to_int(argv[i]);
+                break;
+            case LongOptionWithArgument::MAX_ITERATIONS:
+                batch_parameters.max_iterations = convert_string_to_int(argv[i]);
+                break;
+            case LongOptionWithArgument::THREADS:
+                batch_parameters.thread_amount = convert_string_to_int(argv[i]);
+                break;
+            case LongOptionWithArgument::SEED:
+                parameters.seed = convert_string_to_unsigned_long_long(argv[i]);
+                break;
+            case LongOptionWithArgument::RENDER_EVERY:
+                console_options.render_every = convert_string_to_int(argv[i]);
+                break;
+            case LongOptionWithArgument::STEPS_PER_SECOND:
+                sfml_options.steps_per_second = convert_string_to_int(argv[i]);
+                break;
+            case LongOptionWithArgument::RECORD:
+                parameters.record_file = argv[i];
+                break;
+            case LongOptionWithArgument::REPLAY:
+                parameters.replay_file = argv[i];
+                break;
+            case LongOptionWithArgument::MAP:
+                parameters.map_file = argv[i];
+                break;
+            case LongOptionWithArgument::SAVE_MAP:
+                parameters.save_map_file = argv[i];
+                break;
+            case LongOptionWithArgument::ROBOTS:
+                parameters.robot_amount = convert_string_to_int(argv[i]);
+                break;
+            case LongOptionWithArgument::SENSOR:
+                parameters.sensor_model.type = convert_string_to_sensor_type(argv[i]);
+                break;
+            case LongOptionWithArgument::SENSOR_RANGE:
+                parameters.sensor_model.range = convert_string_to_int(argv[i]);
+                break;
+            case LongOptionWithArgument::RAYS:
+                parameters.sensor_model.ray_amount = convert_string_to_int(argv[i]);
+                break;
+            case LongOptionWithArgument::TOURNAMENT:
+                tournament_parameters.algorithms = split_list(argv[i]);
+                break;
+            case LongOptionWithArgument::GRID_SIZES:
+                tournament_parameters.grid_sizes.clear();
+                for (std::string& size : split_list(argv[i])) {
+                    tournament_parameters.grid_sizes.push_back(convert_string_to_grid_size(&size[0]));
+                }
+                break;
+            case LongOptionWithArgument::DENSITIES:
+                tournament_parameters.obstacle_densities.clear();
+                for (std::string& density : split_list(argv[i])) {
+                    tournament_parameters.obstacle_densities.push_back(convert_string_to_double(&density[0]));
+                }
+                break;
+            case LongOptionWithArgument::SEEDS:
+                tournament_parameters.seed_amount = convert_string_to_int(argv[i]);
+                break;
+            case LongOptionWithArgument::CSV:
+                tournament_parameters.output_file = argv[i];
+                break;
             }
         } else {
             if (std::strcmp(argv[i], "-help") == 0) {
@@ -150,8 +284,71 @@ void parse_arguments(int argc, char* argv[], Parameters& parameters, Mode& mode,
             } else if (std::strcmp(argv[i], "-algorithm") == 0) {
                 is_argument = true;
                 last_option = LongOptionWithArgument::ALGORITHM;
+            } else if (std::strcmp(argv[i], "-batch") == 0) {
+                mode = Mode::BATCH;
+                is_argument = true;
+                last_option = LongOptionWithArgument::BATCH;
+            } else if (std::strcmp(argv[i], "-tournament") == 0) {
+                mode = Mode::TOURNAMENT;
+                is_argument = true;
+                last_option = LongOptionWithArgument::TOURNAMENT;
+            } else if (std::strcmp(argv[i], "-grid-sizes") == 0) {
+                is_argument = true;
+                last_option = LongOptionWithArgument::GRID_SIZES;
+            } else if (std::strcmp(argv[i], "-densities") == 0) {
+                is_argument = true;
+                last_option = LongOptionWithArgument::DENSITIES;
+            } else if (std::strcmp(argv[i], "-seeds") == 0) {
+                is_argument = true;
+                last_option = LongOptionWithArgument::SEEDS;
+            } else if (std::strcmp(argv[i], "-csv") == 0) {
+                is_argument = true;
+                last_option = LongOptionWithArgument::CSV;
+            } else if (std::strcmp(argv[i], "-max-iterations") == 0) {
+                is_argument = true;
+                last_option = LongOptionWithArgument::MAX_ITERATIONS;
+            } else if (std::strcmp(argv[i], "-threads") == 0) {
+                is_argument = true;
+                last_option = LongOptionWithArgument::THREADS;
+            } else if (std::strcmp(argv[i], "-robots") == 0) {
+                is_argument = true;
+                last_option = LongOptionWithArgument::ROBOTS;
+            } else if (std::strcmp(argv[i], "-sensor") == 0) {
+                is_argument = true;
+                last_option = LongOptionWithArgument::SENSOR;
+            } else if (std::strcmp(argv[i], "-sensor-range") == 0) {
+                is_argument = true;
+                last_option = LongOptionWithArgument::SENSOR_RANGE;
+            } else if (std::strcmp(argv[i], "-rays") == 0) {
+                is_argument = true;
+                last_option = LongOptionWithArgument::RAYS;
+            } else if (std::strcmp(argv[i], "-seed") == 0) {
+                is_argument = true;
+                last_option = LongOptionWithArgument::SEED;
             } else if (std::strcmp(argv[i], "-console") == 0) {
                 ui = UI::CONSOLE;
+            } else if (std::strcmp(argv[i], "-ansi") == 0) {
+                console_options.is_diff_rendering = true;
+            } else if (std::strcmp(argv[i], "-render-every") == 0) {
+                is_argument = true;
+                last_option = LongOptionWithArgument::RENDER_EVERY;
+            } else if (std::strcmp(argv[i], "-steps-per-second") == 0) {
+                is_argument = true;
+                last_option = LongOptionWithArgument::STEPS_PER_SECOND;
+            } else if (std::strcmp(argv[i], "-record") == 0) {
+                is_argument = true;
+                last_option = LongOptionWithArgument::RECORD;
+            } else if (std::strcmp(argv[i], "-replay") == 0) {
+                is_argument = true;
+                last_option = LongOptionWithArgument::REPLAY;
+            } else if (std::strcmp(argv[i], "-map") == 0) {
+                is_argument = true;
+                last_option = LongOptionWithArgument::MAP;
+            } else if (std::strcmp(argv[i], "-save-map") == 0) {
+                is_argument = true;
+                last_option = LongOptionWithArgument::SAVE_MAP;
+            } else if (std::strcmp(argv[i], "-profile") == 0) {
+                parameters.is_profiling = true;
             } else {
                 mode = Mode::INVALID_ARGUMENT;
                 done_processing = true;
@@ -167,18 +364,65 @@ void print_help()
     std::cout << "  -list-defaults          List the default settings for the simulation" << std::endl;
     std::cout << "  -list-algorithms        List the available mapping algorithms" << std::endl;
     std::cout << "  -console                Use console UI rather than GUI" << std::endl;
+    std::cout << "  -ansi                   Redraw the console UI in place, only where it changed" << std::endl;
+    std::cout << "  -render-every [int]     Only draw every this many steps in the console UI" << std::endl;
+    std::cout << "  -steps-per-second [int] Change the GUI's step rate, 0 is unlimited (up/down keys" << std::endl;
+    std::cout << "                          double and halve it while running)" << std::endl;
     std::cout << "  -grid-width [int]       Change the grid width" << std::endl;
     std::cout << "  -grid-height [int]      Change the grid height" << std::endl;
     std::cout << "  -obstacle-amount [int]  Change the amount of obstacles" << std::endl;
     std::cout << "  -algorithm [string]     Change the algorithm used" << std::endl;
+    std::cout << "  -robots [int]           Change the amount of robots, which share what they find" << std::endl;
+    std::cout << "  -sensor [string]        Sense with beams to the left, front and right, or with" << std::endl;
+    std::cout << "                          lidar rays all around the robot (beams or lidar)" << std::endl;
+    std::cout << "  -sensor-range [int]     Change how many cells the beams or rays reach" << std::endl;
+    std::cout << "  -rays [int]             Change the amount of lidar rays" << std::endl;
+    std::cout << "  -seed [int]             Change the seed of the simulation (0 picks one)" << std::endl;
+    std::cout << "  -map [string]           Load the world from a map file rather than generating it" << std::endl;
+    std::cout << "                          (binary, PGM image or text with * or # for obstacles)" << std::endl;
+    std::cout << "  -save-map [string]      Save the world to a map file, as text if it ends in .txt," << std::endl;
+    std::cout << "                          as an image if it ends in .pgm and as binary otherwise" << std::endl;
+    std::cout << "  -batch [int]            Run this many trials without a UI and print statistics" << std::endl;
+    std::cout << "  -tournament [list]      Run the comma separated algorithms on the same worlds and" << std::endl;
+    std::cout << "                          print a CSV row per run (iterations, time, and peak memory" << std::endl;
+    std::cout << "                          in builds with COUNT_MEMORY)" << std::endl;
+    std::cout << "  -grid-sizes [list]      Tournament grid sizes, such as 32,64x128 (default: the grid)" << std::endl;
+    std::cout << "  -densities [list]       Tournament obstacle densities, such as 0.05,0.2 (default: the" << std::endl;
+    std::cout << "                          obstacle amount)" << std::endl;
+    std::cout << "  -seeds [int]            Run each tournament world with this many seeds from -seed" << std::endl;
+    std::cout << "  -csv [string]           Write the tournament's CSV to this file" << std::endl;
+    std::cout << "  -max-iterations [int]   Cut batch and tournament runs off after this many iterations" << std::endl;
+    std::cout << "  -threads [int]          Change the amount of batch and tournament threads (default:" << std::endl;
+    std::cout << "                          all cores)" << std::endl;
+    std::cout << "  -profile                Print how long the sense, plan, act and plot phases took" << std::endl;
+    std::cout << "  -record [string]        Record the run to this file" << std::endl;
+    std::cout << "  -replay [string]        Replay a recorded run rather than running an algorithm" << std::endl;
+    std::cout << "                          (left/right keys seek in the GUI)" << std::endl;
 }
 
 void print_parameters(const Parameters& parameters)
 {
-    std::cout << "grid width:      " << parameters.grid_width << std::endl;
-    std::cout << "grid height:     " << parameters.grid_height << std::endl;
-    std::cout << "obstacle amount: " << parameters.obstacle_amount << std::endl;
+    // A map sets the size of the world and its obstacles
+    if (parameters.map_file.empty()) {
+        std::cout << "grid width:      " << parameters.grid_width << std::endl;
+        std::cout << "grid height:     " << parameters.grid_height << std::endl;
+        std::cout << "obstacle amount: " << parameters.obstacle_amount << std::endl;
+    } else {
+        std::cout << "map:             " << parameters.map_file << std::endl;
+    }
     std::cout << "algorithm:       " << parameters.algorithm << std::endl;
+    std::cout << "robots:          " << parameters.robot_amount << std::endl;
+    if (parameters.sensor_model.type == SensorType::BEAMS) {
+        std::cout << "sensor:          beams, range " << parameters.sensor_model.range << std::endl;
+    } else {
+        std::cout << "sensor:          lidar, range " << parameters.sensor_model.range << ", "
+                  << parameters.sensor_model.ray_amount << " rays" << std::endl;
+    }
+    if (parameters.seed == 0) {
+        std::cout << "seed:            random" << std::endl;
+    } else {
+        std::cout << "seed:            " << parameters.seed << std::endl;
+    }
 }
 
 // This function does as expected, but if it cannot convert string to int it
@@ -196,3 +440,84 @@ int convert_string_to_int(char* string)
     }
     return value;
 }
+
+// Same as above, for unsigned long longs
+unsigned long long convert_string_to_unsigned_long_long(char* string)
+{
+    char* endptr;
+    unsigned long long value;
+
+    value = std::strtoull(string, &endptr, 10);
+
+    if (*endptr != '\0') {
+        std::cout << "Could not convert string to integer." << std::endl;
+        std::exit(-1);
+    }
+    return value;
+}
+
+// Same as above, for sensor types
+SensorType convert_string_to_sensor_type(char* string)
+{
+    if (std::strcmp(string, "lidar") == 0) {
+        return SensorType::LIDAR;
+    } else if (std::strcmp(string, "beams") != 0) {
+        std::cout << "Could not convert string to sensor type." << std::endl;
+        std::exit(-1);
+    }
+    return SensorType::BEAMS;
+}
+
+// Same as above, for doubles
+double convert_string_to_double(char* string)
+{
+    char* endptr;
+    double value;
+
+    value = std::strtod(string, &endptr);
+
+    if (*endptr != '\0') {
+        std::cout << "Could not convert string to number." << std::endl;
+        std::exit(-1);
+    }
+    return value;
+}
+
+// Converts a size written as widthxheight, or as a single number for square
+// grids
+Vector2 convert_string_to_grid_size(char* string)
+{
+    char* separator = std::strchr(string, 'x');
+    if (separator == nullptr) {
+        int size = convert_string_to_int(string);
+        return Vector2(size, size);
+    }
+
+    *separator = '\0';
+    return Vector2(convert_string_to_int(string), convert_string_to_int(separator + 1));
+}
+
+// Splits a comma separated list
+std::vector<std::string> split_list(char* string)
+{
+    std::vector<std::string> items(1);
+    for (char* c = string; *c != '\0'; c++) {
+        if (*c == ',') {
+            items.emplace_back();
+        } else {
+            items.back() += *c;
+        }
+    }
+    return items;
+}
+
+// Mixes the system's entropy source with the clock, since the entropy source
+// is deterministic on some platforms
+unsigned long long generate_seed()
+{
+    std::random_device device;
+    unsigned long long seed = device();
+    seed = (seed << 32) ^ device();
+    seed ^= std::chrono::high_resolution_clock::now().time_since_epoch().count();
+    return seed == 0 ? 1 : seed;
+}
@@ -0,0 +1,143 @@
+// Includes
+#include "mapped_file.h"
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() : m_data(nullptr), m_size(0)
+{
+#ifdef _WIN32
+    m_file = INVALID_HANDLE_VALUE;
+    m_mapping = nullptr;
+#else
+    m_descriptor = -1;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path)
+{
+    close();
+
+    m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                         OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size)) {
+        close();
+        return false;
+    }
+    m_size = size.QuadPart;
+
+    // Empty files cannot be mapped, but are still open
+    if (m_size > 0) {
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (m_mapping == nullptr) {
+            close();
+            return false;
+        }
+        m_data = static_cast<const unsigned char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        if (m_data == nullptr) {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data != nullptr) {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping != nullptr) {
+        CloseHandle(m_mapping);
+    }
+    if (m_file != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_file);
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_file = INVALID_HANDLE_VALUE;
+    m_mapping = nullptr;
+}
+
+bool MappedFile::is_open() const
+{
+    return m_file != INVALID_HANDLE_VALUE;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path)
+{
+    close();
+
+    m_descriptor = ::open(path.c_str(), O_RDONLY);
+    if (m_descriptor < 0) {
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(m_descriptor, &status) != 0) {
+        close();
+        return false;
+    }
+    m_size = status.st_size;
+
+    // Empty files cannot be mapped, but are still open
+    if (m_size > 0) {
+        void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_descriptor, 0);
+        if (data == MAP_FAILED) {
+            close();
+            return false;
+        }
+        m_data = static_cast<const unsigned char*>(data);
+    }
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data != nullptr) {
+        munmap(const_cast<unsigned char*>(m_data), m_size);
+    }
+    if (m_descriptor >= 0) {
+        ::close(m_descriptor);
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_descriptor = -1;
+}
+
+bool MappedFile::is_open() const
+{
+    return m_descriptor >= 0;
+}
+
+#endif
+
+const unsigned char* MappedFile::get_data() const
+{
+    return m_data;
+}
+
+std::size_t MappedFile::get_size() const
+{
+    return m_size;
+}
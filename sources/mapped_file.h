@@ -0,0 +1,37 @@
+// Begin header guard
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+// Includes
+#include <cstddef>
+#include <string>
+
+// A read-only view of a whole file mapped into memory, so that large files
+// can be read without copying them and only the parts used are loaded
+class MappedFile {
+private:
+    const unsigned char* m_data;
+    std::size_t m_size;
+#ifdef _WIN32
+    void* m_file;
+    void* m_mapping;
+#else
+    int m_descriptor;
+#endif
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    // Maps the file, closing any file mapped before. Returns whether the file
+    // could be mapped.
+    bool open(const std::string& path);
+    void close();
+    bool is_open() const;
+    // Null for empty files
+    const unsigned char* get_data() const;
+    std::size_t get_size() const;
+};
+
+// End header guard
+#endif
@@ -0,0 +1,183 @@
+// Includes
+#include "memory_counter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// The global operator new and delete are only replaced in builds that count
+// memory, since the header and the counters cost every allocation
+#ifdef COUNT_MEMORY
+
+// Local types
+// The counters of one thread. Other threads take the blocks they free off the
+// counters of the thread that allocated them, so the allocated bytes are
+// atomic. Counters are never freed, since blocks can outlive their thread.
+struct ThreadMemory {
+    std::atomic<long long> allocated_memory;
+    long long peak_memory;
+    long long allocation_amount;
+};
+
+// Every block starts with its size and the counters of the thread that
+// allocated it
+struct BlockHeader {
+    std::size_t size;
+    ThreadMemory* owner;
+};
+
+// Local constants
+// The header keeps the alignment malloc gives
+static const std::size_t HEADER_SIZE = 16;
+static_assert(sizeof(BlockHeader) <= HEADER_SIZE, "The block header does not fit.");
+
+// Local variables
+static thread_local ThreadMemory* t_memory = nullptr;
+
+// Local function prototypes
+static ThreadMemory* get_thread_memory();
+static void* allocate(std::size_t size);
+static void deallocate(void* pointer);
+
+bool is_memory_counted()
+{
+    return true;
+}
+
+// A thread whose counters could not be made has counted nothing
+long long get_allocated_memory()
+{
+    ThreadMemory* memory = get_thread_memory();
+    return memory != nullptr ? memory->allocated_memory.load(std::memory_order_relaxed) : 0;
+}
+
+long long get_peak_memory()
+{
+    ThreadMemory* memory = get_thread_memory();
+    return memory != nullptr ? memory->peak_memory : 0;
+}
+
+void reset_peak_memory()
+{
+    ThreadMemory* memory = get_thread_memory();
+    if (memory != nullptr) {
+        memory->peak_memory = memory->allocated_memory.load(std::memory_order_relaxed);
+    }
+}
+
+long long get_allocation_amount()
+{
+    ThreadMemory* memory = get_thread_memory();
+    return memory != nullptr ? memory->allocation_amount : 0;
+}
+
+// The counters are made with malloc, as new would count itself
+ThreadMemory* get_thread_memory()
+{
+    if (t_memory == nullptr) {
+        void* counters = std::malloc(sizeof(ThreadMemory));
+        if (counters != nullptr) {
+            t_memory = new (counters) ThreadMemory();
+        }
+    }
+    return t_memory;
+}
+
+void* allocate(std::size_t size)
+{
+    ThreadMemory* memory = get_thread_memory();
+    void* block = memory != nullptr ? std::malloc(size + HEADER_SIZE) : nullptr;
+    if (block == nullptr) {
+        return nullptr;
+    }
+
+    BlockHeader* header = static_cast<BlockHeader*>(block);
+    header->size = size;
+    header->owner = memory;
+    memory->allocation_amount++;
+    long long allocated_memory = memory->allocated_memory.fetch_add(size, std::memory_order_relaxed) + size;
+    if (allocated_memory > memory->peak_memory) {
+        memory->peak_memory = allocated_memory;
+    }
+    return static_cast<char*>(block) + HEADER_SIZE;
+}
+
+void deallocate(void* pointer)
+{
+    if (pointer != nullptr) {
+        BlockHeader* header = reinterpret_cast<BlockHeader*>(static_cast<char*>(pointer) - HEADER_SIZE);
+        header->owner->allocated_memory.fetch_sub(header->size, std::memory_order_relaxed);
+        std::free(header);
+    }
+}
+
+void* operator new(std::size_t size)
+{
+    void* pointer = allocate(size);
+    if (pointer == nullptr) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    deallocate(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    deallocate(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+    deallocate(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+    deallocate(pointer);
+}
+
+#else
+
+bool is_memory_counted()
+{
+    return false;
+}
+
+long long get_allocated_memory()
+{
+    return 0;
+}
+
+long long get_peak_memory()
+{
+    return 0;
+}
+
+void reset_peak_memory()
+{
+}
+
+long long get_allocation_amount()
+{
+    return 0;
+}
+
+#endif
@@ -0,0 +1,23 @@
+// Begin header guard
+#ifndef MEMORY_COUNTER_H
+#define MEMORY_COUNTER_H
+
+// Counts the bytes every thread allocates with new, so that the memory taken
+// by one simulation can be measured while other threads run others. Only
+// builds with COUNT_MEMORY defined replace the global operator new and delete
+// to count; the benchmarks always do, the simulator with the CMake option
+// COUNT_MEMORY. Other builds count nothing.
+
+// Whether this build counts memory
+bool is_memory_counted();
+// The bytes this thread has allocated and not freed. Memory freed by another
+// thread is still taken off the thread that allocated it.
+long long get_allocated_memory();
+// The most bytes this thread has had allocated since the last reset
+long long get_peak_memory();
+void reset_peak_memory();
+// The amount of allocations this thread has made
+long long get_allocation_amount();
+
+// End header guard
+#endif
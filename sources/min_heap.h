@@ -0,0 +1,59 @@
+// Begin header guard
+#ifndef MIN_HEAP_H
+#define MIN_HEAP_H
+
+// Includes
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+// A priority queue with the smallest element on top, as compared by the
+// element's operator>. Unlike std::priority_queue it can be cleared, which
+// keeps its storage, so a search can reuse the memory of the ones before it
+// instead of allocating its open list anew.
+template <class T>
+class MinHeap {
+private:
+    std::vector<T> m_elements;
+public:
+    void clear();
+    bool empty() const;
+    const T& top() const;
+    void push(const T&);
+    void pop();
+};
+
+template <class T>
+void MinHeap<T>::clear()
+{
+    m_elements.clear();
+}
+
+template <class T>
+bool MinHeap<T>::empty() const
+{
+    return m_elements.empty();
+}
+
+template <class T>
+const T& MinHeap<T>::top() const
+{
+    return m_elements.front();
+}
+
+template <class T>
+void MinHeap<T>::push(const T& element)
+{
+    m_elements.push_back(element);
+    std::push_heap(m_elements.begin(), m_elements.end(), std::greater<T>());
+}
+
+template <class T>
+void MinHeap<T>::pop()
+{
+    std::pop_heap(m_elements.begin(), m_elements.end(), std::greater<T>());
+    m_elements.pop_back();
+}
+
+// End header guard
+#endif
@@ -0,0 +1,209 @@
+// Includes
+#include "occupancy_grid.h"
+#include <algorithm>
+
+// Local constants
+// Grids with more cells than this are tiled, see occupancy_grid.h
+static const long long MAX_DENSE_CELL_AMOUNT = 1LL << 28;
+static const int TILE_SIZE = 8;
+
+// Local function prototypes
+static int count_bits(unsigned long long bits);
+static bool is_before(Vector2, Vector2);
+
+OccupancyGrid::OccupancyGrid()
+    : m_width(0), m_height(0), m_data(nullptr), m_is_view(false), m_is_tiled(false), m_tile_columns(0)
+{
+}
+
+OccupancyGrid::OccupancyGrid(int width, int height)
+{
+    reset(width, height);
+}
+
+// A copy views the same bits or owns a copy of them, never those of the
+// grid it was copied from
+OccupancyGrid::OccupancyGrid(const OccupancyGrid& other)
+    : m_width(other.m_width), m_height(other.m_height), m_bits(other.m_bits),
+      m_data(other.m_is_view ? other.m_data : m_bits.data()), m_is_view(other.m_is_view),
+      m_is_tiled(other.m_is_tiled), m_tile_columns(other.m_tile_columns), m_tiles(other.m_tiles)
+{
+}
+
+OccupancyGrid& OccupancyGrid::operator=(const OccupancyGrid& other)
+{
+    m_width = other.m_width;
+    m_height = other.m_height;
+    m_bits = other.m_bits;
+    m_data = other.m_is_view ? other.m_data : m_bits.data();
+    m_is_view = other.m_is_view;
+    m_is_tiled = other.m_is_tiled;
+    m_tile_columns = other.m_tile_columns;
+    m_tiles = other.m_tiles;
+    return *this;
+}
+
+void OccupancyGrid::reset(int width, int height)
+{
+    m_width = width;
+    m_height = height;
+    m_is_view = false;
+    m_is_tiled = static_cast<long long>(width) * height > MAX_DENSE_CELL_AMOUNT;
+    m_tile_columns = (static_cast<long long>(width) + TILE_SIZE - 1) / TILE_SIZE;
+    m_tiles.clear();
+
+    if (m_is_tiled) {
+        m_bits.clear();
+        m_bits.shrink_to_fit();
+    } else {
+        m_bits.assign((static_cast<long long>(width) * height + 7) / 8, 0);
+    }
+    m_data = m_bits.data();
+}
+
+void OccupancyGrid::view(int width, int height, const unsigned char* bits)
+{
+    m_width = width;
+    m_height = height;
+    m_bits.clear();
+    m_bits.shrink_to_fit();
+    m_data = bits;
+    m_is_view = true;
+    m_is_tiled = false;
+    m_tiles.clear();
+}
+
+bool OccupancyGrid::is_in_bounds(Vector2 cell) const
+{
+    return cell.x >= 0 && cell.y >= 0 && cell.x < m_width && cell.y < m_height;
+}
+
+bool OccupancyGrid::is_occupied(Vector2 cell) const
+{
+    if (!is_in_bounds(cell)) {
+        return false;
+    }
+
+    if (m_is_tiled) {
+        long long tile_index = cell.y / TILE_SIZE * m_tile_columns + cell.x / TILE_SIZE;
+        std::unordered_map<long long, unsigned long long>::const_iterator tile = m_tiles.find(tile_index);
+        int bit = cell.y % TILE_SIZE * TILE_SIZE + cell.x % TILE_SIZE;
+        return tile != m_tiles.end() && ((tile->second >> bit) & 1);
+    }
+
+    long long index = static_cast<long long>(cell.y) * m_width + cell.x;
+    return (m_data[index >> 3] >> (index & 7)) & 1;
+}
+
+void OccupancyGrid::set_occupied(Vector2 cell, bool occupied)
+{
+    if (!is_in_bounds(cell) || m_is_view) {
+        return;
+    }
+
+    if (m_is_tiled) {
+        long long tile_index = cell.y / TILE_SIZE * m_tile_columns + cell.x / TILE_SIZE;
+        unsigned long long mask = 1ULL << (cell.y % TILE_SIZE * TILE_SIZE + cell.x % TILE_SIZE);
+        if (occupied) {
+            m_tiles[tile_index] |= mask;
+        } else {
+            // Free cells of missing tiles are already free
+            std::unordered_map<long long, unsigned long long>::iterator tile = m_tiles.find(tile_index);
+            if (tile != m_tiles.end()) {
+                tile->second &= ~mask;
+            }
+        }
+        return;
+    }
+
+    long long index = static_cast<long long>(cell.y) * m_width + cell.x;
+    unsigned char mask = static_cast<unsigned char>(1 << (index & 7));
+    if (occupied) {
+        m_bits[index >> 3] |= mask;
+    } else {
+        m_bits[index >> 3] &= ~mask;
+    }
+}
+
+int OccupancyGrid::get_width() const
+{
+    return m_width;
+}
+
+int OccupancyGrid::get_height() const
+{
+    return m_height;
+}
+
+bool OccupancyGrid::is_tiled() const
+{
+    return m_is_tiled;
+}
+
+long long OccupancyGrid::count_occupied() const
+{
+    long long amount = 0;
+    if (m_is_tiled) {
+        for (const std::pair<const long long, unsigned long long>& tile : m_tiles) {
+            amount += count_bits(tile.second);
+        }
+    } else {
+        for (long long i = 0; i < get_byte_size(); i++) {
+            amount += count_bits(m_data[i]);
+        }
+    }
+    return amount;
+}
+
+void OccupancyGrid::append_occupied_cells(std::vector<Vector2>& cells) const
+{
+    std::size_t first = cells.size();
+
+    if (m_is_tiled) {
+        for (const std::pair<const long long, unsigned long long>& tile : m_tiles) {
+            Vector2 corner(tile.first % m_tile_columns * TILE_SIZE, tile.first / m_tile_columns * TILE_SIZE);
+            for (int bit = 0; bit < TILE_SIZE * TILE_SIZE; bit++) {
+                if ((tile.second >> bit) & 1) {
+                    cells.push_back(corner + Vector2(bit % TILE_SIZE, bit / TILE_SIZE));
+                }
+            }
+        }
+        // The tiles are in no particular order
+        std::sort(cells.begin() + first, cells.end(), is_before);
+    } else {
+        // Most bytes of a sparse grid are empty and skipped whole
+        for (long long i = 0; i < get_byte_size(); i++) {
+            for (int bit = 0; m_data[i] >> bit != 0; bit++) {
+                if ((m_data[i] >> bit) & 1) {
+                    long long index = i * 8 + bit;
+                    cells.push_back(Vector2(index % m_width, index / m_width));
+                }
+            }
+        }
+    }
+}
+
+const unsigned char* OccupancyGrid::get_bits() const
+{
+    return m_is_tiled ? nullptr : m_data;
+}
+
+long long OccupancyGrid::get_byte_size() const
+{
+    return (static_cast<long long>(m_width) * m_height + 7) / 8;
+}
+
+int count_bits(unsigned long long bits)
+{
+    int amount = 0;
+    // Each step clears the lowest set bit
+    for (; bits != 0; bits &= bits - 1) {
+        amount++;
+    }
+    return amount;
+}
+
+bool is_before(Vector2 a, Vector2 b)
+{
+    return a.y < b.y || (a.y == b.y && a.x < b.x);
+}
@@ -0,0 +1,59 @@
+// Begin header guard
+#ifndef OCCUPANCY_GRID_H
+#define OCCUPANCY_GRID_H
+
+// Includes
+#include "data_types.h"
+#include <unordered_map>
+#include <vector>
+
+// This class stores which cells of a grid are occupied. The cells are stored
+// row-major, one bit per cell, so a query for any cell is O(1) and a 500x500
+// grid only takes about 31 kilobytes. A grid can also be a read-only view of
+// bits stored elsewhere, such as in a memory mapped map file.
+//
+// Grids too large to store densely are tiled instead: the bits of every tile
+// of 8x8 cells are one 64-bit word in a hash map, and a tile is only added
+// once one of its cells is occupied. Such a grid takes memory for the areas
+// with occupied cells rather than for the whole grid.
+class OccupancyGrid {
+private:
+    int m_width;
+    int m_height;
+    std::vector<unsigned char> m_bits;
+    // The bits queries read, either those of m_bits or those viewed
+    const unsigned char* m_data;
+    bool m_is_view;
+    // Tiles by tile index, row-major like the cells
+    bool m_is_tiled;
+    long long m_tile_columns;
+    std::unordered_map<long long, unsigned long long> m_tiles;
+public:
+    OccupancyGrid();
+    OccupancyGrid(int width, int height);
+    OccupancyGrid(const OccupancyGrid&);
+    OccupancyGrid& operator=(const OccupancyGrid&);
+    // Resizes the grid and marks every cell as free
+    void reset(int width, int height);
+    // Makes the grid a view of bits stored the same way as its own, which
+    // must outlive the view. Setting cells of a view does nothing.
+    void view(int width, int height, const unsigned char* bits);
+    bool is_in_bounds(Vector2) const;
+    // Cells outside of the grid are never occupied
+    bool is_occupied(Vector2) const;
+    void set_occupied(Vector2, bool);
+    int get_width() const;
+    int get_height() const;
+    bool is_tiled() const;
+    long long count_occupied() const;
+    // Adds the occupied cells to the vector in row-major order, without
+    // looking at every cell of a tiled grid
+    void append_occupied_cells(std::vector<Vector2>&) const;
+    // Row-major from the bottom row, one bit per cell starting at the lowest.
+    // Tiled grids have no such bits, so they return null.
+    const unsigned char* get_bits() const;
+    long long get_byte_size() const;
+};
+
+// End header guard
+#endif
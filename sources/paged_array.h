@@ -0,0 +1,91 @@
+// Begin header guard
+#ifndef PAGED_ARRAY_H
+#define PAGED_ARRAY_H
+
+// Includes
+#include <unordered_map>
+#include <vector>
+
+// An array indexed by 64-bit indices whose elements all start out as the same
+// value. Arrays of up to MAX_DENSE_SIZE elements are a single vector. Larger
+// arrays are split into pages of PAGE_SIZE elements that are only allocated
+// once an element of them is written to, so an array over a huge world only
+// takes memory for the parts of it that were used. Reading with get never
+// allocates, while operator[] allocates the element's page.
+template <class T>
+class PagedArray {
+private:
+    long long m_size;
+    T m_value;
+    bool m_is_paged;
+    std::vector<T> m_elements;
+    std::unordered_map<long long, std::vector<T>> m_pages;
+public:
+    static const long long PAGE_SIZE = 256;
+    static const long long MAX_DENSE_SIZE = 1LL << 26;
+    PagedArray();
+    // Resizes the array and sets every element to the value, keeping the
+    // allocation of a dense array
+    void assign(long long size, const T& value);
+    long long size() const;
+    const T& get(long long index) const;
+    T& operator[](long long index);
+};
+
+template <class T>
+PagedArray<T>::PagedArray() : m_size(0), m_value(), m_is_paged(false)
+{
+}
+
+template <class T>
+void PagedArray<T>::assign(long long size, const T& value)
+{
+    m_size = size;
+    m_value = value;
+    m_is_paged = size > MAX_DENSE_SIZE;
+    m_pages.clear();
+
+    if (m_is_paged) {
+        m_elements.clear();
+        m_elements.shrink_to_fit();
+    } else {
+        m_elements.assign(size, value);
+    }
+}
+
+template <class T>
+long long PagedArray<T>::size() const
+{
+    return m_size;
+}
+
+template <class T>
+const T& PagedArray<T>::get(long long index) const
+{
+    if (!m_is_paged) {
+        return m_elements[index];
+    }
+
+    typename std::unordered_map<long long, std::vector<T>>::const_iterator page = m_pages.find(index / PAGE_SIZE);
+    if (page == m_pages.end()) {
+        return m_value;
+    }
+    return page->second[index % PAGE_SIZE];
+}
+
+template <class T>
+T& PagedArray<T>::operator[](long long index)
+{
+    if (!m_is_paged) {
+        return m_elements[index];
+    }
+
+    std::vector<T>& page = m_pages[index / PAGE_SIZE];
+    if (page.empty()) {
+        page.assign(PAGE_SIZE, m_value);
+    }
+    return page[index % PAGE_SIZE];
+}
+
+// End header guard
+#endif
@@ -0,0 +1,155 @@
+// Includes
+#include "phase_profile.h"
+#include <algorithm>
+#include <iomanip>
+
+// Local constants
+static const char* PHASE_NAMES[PHASE_AMOUNT] = {"sense", "plan", "act", "plot"};
+
+// Local function prototypes
+static int find_highest_bit(unsigned long long);
+
+DurationHistogram::DurationHistogram()
+{
+    clear();
+}
+
+void DurationHistogram::clear()
+{
+    std::fill(m_bucket_counts, m_bucket_counts + BUCKET_AMOUNT, 0);
+    m_count = 0;
+    m_total = 0;
+    m_maximum = 0;
+}
+
+void DurationHistogram::add(long long nanoseconds)
+{
+    if (nanoseconds < 0) {
+        nanoseconds = 0;
+    }
+    m_bucket_counts[bucket_index(nanoseconds)]++;
+    m_count++;
+    m_total += nanoseconds;
+    m_maximum = std::max(m_maximum, nanoseconds);
+}
+
+void DurationHistogram::merge(const DurationHistogram& other)
+{
+    for (int i = 0; i < BUCKET_AMOUNT; i++) {
+        m_bucket_counts[i] += other.m_bucket_counts[i];
+    }
+    m_count += other.m_count;
+    m_total += other.m_total;
+    m_maximum = std::max(m_maximum, other.m_maximum);
+}
+
+long long DurationHistogram::get_count() const
+{
+    return m_count;
+}
+
+long long DurationHistogram::get_total() const
+{
+    return m_total;
+}
+
+long long DurationHistogram::get_maximum() const
+{
+    return m_maximum;
+}
+
+long long DurationHistogram::get_percentile(double percentile) const
+{
+    // Nearest rank
+    long long rank = static_cast<long long>(percentile / 100 * m_count + 0.5);
+    rank = std::max(1LL, std::min(rank, m_count));
+
+    long long seen = 0;
+    for (int i = 0; i < BUCKET_AMOUNT; i++) {
+        seen += m_bucket_counts[i];
+        if (seen >= rank) {
+            return std::min(bucket_upper_bound(i), m_maximum);
+        }
+    }
+    return m_maximum;
+}
+
+// Durations below SUB_BUCKET_AMOUNT get a bucket each. Larger ones are put in
+// one of the SUB_BUCKET_AMOUNT buckets of their power of two, chosen by the
+// bits just below the highest one.
+int DurationHistogram::bucket_index(long long nanoseconds)
+{
+    if (nanoseconds < SUB_BUCKET_AMOUNT) {
+        return nanoseconds;
+    }
+    int highest_bit = find_highest_bit(nanoseconds);
+    int sub_bucket = (nanoseconds >> (highest_bit - 3)) & (SUB_BUCKET_AMOUNT - 1);
+    return (highest_bit - 2) * SUB_BUCKET_AMOUNT + sub_bucket;
+}
+
+long long DurationHistogram::bucket_upper_bound(int index)
+{
+    if (index < SUB_BUCKET_AMOUNT) {
+        return index;
+    }
+    int highest_bit = index / SUB_BUCKET_AMOUNT + 2;
+    long long sub_bucket = index % SUB_BUCKET_AMOUNT;
+    return ((SUB_BUCKET_AMOUNT + sub_bucket + 1) << (highest_bit - 3)) - 1;
+}
+
+void PhaseProfile::clear()
+{
+    for (int i = 0; i < PHASE_AMOUNT; i++) {
+        m_histograms[i].clear();
+    }
+}
+
+void PhaseProfile::add(Phase phase, long long nanoseconds)
+{
+    m_histograms[phase].add(nanoseconds);
+}
+
+void PhaseProfile::merge(const PhaseProfile& other)
+{
+    for (int i = 0; i < PHASE_AMOUNT; i++) {
+        m_histograms[i].merge(other.m_histograms[i]);
+    }
+}
+
+const DurationHistogram& PhaseProfile::get_histogram(Phase phase) const
+{
+    return m_histograms[phase];
+}
+
+void PhaseProfile::print(std::ostream& stream) const
+{
+    std::ios::fmtflags flags = stream.flags();
+    std::streamsize precision = stream.precision();
+
+    stream << "Phase times (microseconds):" << std::endl;
+    stream << std::fixed << std::setprecision(3);
+    for (int i = 0; i < PHASE_AMOUNT; i++) {
+        const DurationHistogram& histogram = m_histograms[i];
+        stream << "  " << std::left << std::setw(6) << PHASE_NAMES[i] << std::right
+               << " count " << histogram.get_count()
+               << ", total " << histogram.get_total() / 1000.0
+               << ", p50 " << histogram.get_percentile(50) / 1000.0
+               << ", p99 " << histogram.get_percentile(99) / 1000.0
+               << ", max " << histogram.get_maximum() / 1000.0 << std::endl;
+    }
+    stream.flags(flags);
+    stream.precision(precision);
+}
+
+// Binary search for the highest set bit of a non-zero value
+int find_highest_bit(unsigned long long value)
+{
+    int highest_bit = 0;
+    for (int shift = 32; shift > 0; shift /= 2) {
+        if (value >> shift) {
+            value >>= shift;
+            highest_bit += shift;
+        }
+    }
+    return highest_bit;
+}
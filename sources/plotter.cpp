@@ -3,11 +3,36 @@
 #include "plotter.h"
 #include "application.h"
 
-Plotter::Plotter(Application& a) : m_app(a)
+Plotter::Plotter(Application& a, int robot) : m_app(a), m_robot(robot), m_plotted_obstacle_amount(0)
 {
 }
 
+void Plotter::reset()
+{
+    m_plotted_obstacle_amount = 0;
+}
+
+void Plotter::plot_obstacle(Vector2 obstacle)
+{
+    m_app.add_found_obstacle(obstacle);
+}
+
+void Plotter::plot_seen_space(Vector2 space)
+{
+    m_app.add_seen_space(space);
+}
+
+void Plotter::plot_path(const std::vector<Vector2>& path)
+{
+    if (m_robot == 0) {
+        m_app.set_planned_path(path);
+    }
+}
+
 void Plotter::plot(const std::vector<Vector2>& obstacles)
 {
-    m_app.set_found_obstacles(obstacles);
+    for (std::size_t i = m_plotted_obstacle_amount; i < obstacles.size(); i++) {
+        m_app.add_found_obstacle(obstacles[i]);
+    }
+    m_plotted_obstacle_amount = obstacles.size();
 }
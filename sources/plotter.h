@@ -5,14 +5,31 @@
 
 // Includes
 #include "data_types.h"
+#include <vector>
 
 class Application;
 
+// Plots for one robot, the given one of the application's robots
 class Plotter {
 private:
     Application& m_app;
+    int m_robot;
+    std::size_t m_plotted_obstacle_amount;
 public:
-    Plotter(Application&);
+    Plotter(Application&, int robot = 0);
+    // Forgets what was plotted, for a new run
+    void reset();
+    // Reports an obstacle found since the last plot
+    void plot_obstacle(Vector2);
+    // Reports a space of the grid seen for the first time
+    void plot_seen_space(Vector2);
+    // Replaces the path the robot is planning to take. Only robot zero's path
+    // is shown.
+    void plot_path(const std::vector<Vector2>& path);
+    // For algorithms that keep their own list of found obstacles, which may
+    // only ever be added to. Only the obstacles past the ones plotted before
+    // by this plotter are reported, so this takes time in the amount of new
+    // obstacles.
     void plot(const std::vector<Vector2>& obstacles);
 };
 
@@ -0,0 +1,59 @@
+// Includes
+#include "random_generator.h"
+
+// Local function prototypes
+static std::uint64_t rotate_left(std::uint64_t, int);
+static std::uint64_t split_mix(std::uint64_t&);
+
+RandomGenerator::RandomGenerator(std::uint64_t seed)
+{
+    this->seed(seed);
+}
+
+void RandomGenerator::seed(std::uint64_t seed)
+{
+    // Spread the seed over the whole state, which must not be all zeros
+    for (int i = 0; i < 4; i++) {
+        m_state[i] = split_mix(seed);
+    }
+}
+
+std::uint64_t RandomGenerator::next()
+{
+    std::uint64_t result = rotate_left(m_state[1] * 5, 7) * 9;
+    std::uint64_t t = m_state[1] << 17;
+
+    m_state[2] ^= m_state[0];
+    m_state[3] ^= m_state[1];
+    m_state[1] ^= m_state[2];
+    m_state[0] ^= m_state[3];
+    m_state[2] ^= t;
+    m_state[3] = rotate_left(m_state[3], 45);
+
+    return result;
+}
+
+std::uint64_t RandomGenerator::next_below(std::uint64_t upper_bound)
+{
+    // Reject the values that would make some results more likely than others
+    std::uint64_t limit = -upper_bound % upper_bound;
+    std::uint64_t value = next();
+    while (value < limit) {
+        value = next();
+    }
+    return value % upper_bound;
+}
+
+std::uint64_t rotate_left(std::uint64_t value, int amount)
+{
+    return (value << amount) | (value >> (64 - amount));
+}
+
+std::uint64_t split_mix(std::uint64_t& state)
+{
+    state += 0x9e3779b97f4a7c15ULL;
+    std::uint64_t z = state;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
@@ -0,0 +1,25 @@
+// Begin header guard
+#ifndef RANDOM_GENERATOR_H
+#define RANDOM_GENERATOR_H
+
+// Includes
+#include <cstdint>
+
+// A small, fast pseudo random number generator (xoshiro256** by Blackman and
+// Vigna). Unlike std::rand every instance has its own state, so simulations
+// seeded the same way always play out the same way, even when several of them
+// run at once.
+class RandomGenerator {
+private:
+    std::uint64_t m_state[4];
+public:
+    RandomGenerator(std::uint64_t seed = 0);
+    void seed(std::uint64_t);
+    std::uint64_t next();
+    // Returns a uniformly distributed integer from zero up to, but not
+    // including, the upper bound
+    std::uint64_t next_below(std::uint64_t upper_bound);
+};
+
+// End header guard
+#endif
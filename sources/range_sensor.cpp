@@ -0,0 +1,118 @@
+// Includes
+#include "range_sensor.h"
+#include <cmath>
+#include <limits>
+
+// Local constants
+// The cell in front of a robot for every orientation
+static const Vector2 FRONT_STEPS[4] = {Vector2(0, 1), Vector2(-1, 0), Vector2(0, -1), Vector2(1, 0)};
+static const double PI = 3.14159265358979323846;
+
+RangeSensor::RangeSensor()
+{
+    SensorModel model = {SensorType::BEAMS, 1, 0};
+    set_model(model);
+}
+
+void RangeSensor::set_model(const SensorModel& model)
+{
+    m_model = model;
+    m_ray_directions_x.clear();
+    m_ray_directions_y.clear();
+
+    if (m_model.type == SensorType::LIDAR) {
+        for (int i = 0; i < m_model.ray_amount; i++) {
+            double angle = 2 * PI * i / m_model.ray_amount;
+            m_ray_directions_x.push_back(std::sin(angle));
+            m_ray_directions_y.push_back(std::cos(angle));
+        }
+    }
+}
+
+const SensorModel& RangeSensor::get_model() const
+{
+    return m_model;
+}
+
+void RangeSensor::scan(const OccupancyGrid& world, Vector2 position, int orientation, SensorScan& scan) const
+{
+    scan.free_cells.clear();
+    scan.hit_cells.clear();
+
+    if (m_model.type == SensorType::BEAMS) {
+        cast_beam(world, position, FRONT_STEPS[(orientation + 1) % 4], scan);
+        cast_beam(world, position, FRONT_STEPS[orientation], scan);
+        cast_beam(world, position, FRONT_STEPS[(orientation + 3) % 4], scan);
+        return;
+    }
+
+    for (int i = 0; i < m_ray_directions_x.size(); i++) {
+        // Every turn to the left rotates the rays by a quarter turn
+        double direction_x = m_ray_directions_x[i];
+        double direction_y = m_ray_directions_y[i];
+        for (int turn = 0; turn < orientation; turn++) {
+            double x = direction_x;
+            direction_x = -direction_y;
+            direction_y = x;
+        }
+        cast_ray(world, position, direction_x, direction_y, scan);
+    }
+}
+
+void RangeSensor::cast_beam(const OccupancyGrid& world, Vector2 position, Vector2 step, SensorScan& scan) const
+{
+    Vector2 cell = position;
+    for (int distance = 0; distance < m_model.range; distance++) {
+        cell = cell + step;
+        if (!world.is_in_bounds(cell)) {
+            scan.free_cells.push_back(cell);
+            return;
+        }
+        if (world.is_occupied(cell)) {
+            scan.hit_cells.push_back(cell);
+            return;
+        }
+        scan.free_cells.push_back(cell);
+    }
+}
+
+// The ray starts in the middle of the robot's cell. t is the distance along
+// the ray, and the next cell is the one whose border the ray crosses first.
+void RangeSensor::cast_ray(const OccupancyGrid& world, Vector2 position, double direction_x, double direction_y,
+                           SensorScan& scan) const
+{
+    const double infinity = std::numeric_limits<double>::infinity();
+    int step_x = direction_x < 0 ? -1 : 1;
+    int step_y = direction_y < 0 ? -1 : 1;
+    double t_delta_x = direction_x != 0 ? std::fabs(1 / direction_x) : infinity;
+    double t_delta_y = direction_y != 0 ? std::fabs(1 / direction_y) : infinity;
+    double t_max_x = t_delta_x / 2;
+    double t_max_y = t_delta_y / 2;
+    Vector2 cell = position;
+
+    while (true) {
+        if (t_max_x < t_max_y) {
+            if (t_max_x > m_model.range) {
+                return;
+            }
+            cell.x += step_x;
+            t_max_x += t_delta_x;
+        } else {
+            if (t_max_y > m_model.range) {
+                return;
+            }
+            cell.y += step_y;
+            t_max_y += t_delta_y;
+        }
+
+        if (!world.is_in_bounds(cell)) {
+            scan.free_cells.push_back(cell);
+            return;
+        }
+        if (world.is_occupied(cell)) {
+            scan.hit_cells.push_back(cell);
+            return;
+        }
+        scan.free_cells.push_back(cell);
+    }
+}
@@ -0,0 +1,58 @@
+// Begin header guard
+#ifndef RANGE_SENSOR_H
+#define RANGE_SENSOR_H
+
+// Includes
+#include "data_types.h"
+#include "occupancy_grid.h"
+#include <vector>
+
+enum class SensorType {
+    // Beams to the left, front and right of the robot. Beams of one cell are
+    // the sensor read_sensor models.
+    BEAMS,
+    // Rays spread evenly all around the robot, the first straight ahead
+    LIDAR,
+};
+
+struct SensorModel {
+    SensorType type;
+    // How far the beams or rays reach, in cells
+    int range;
+    // The amount of rays of a lidar, unused by beams
+    int ray_amount;
+};
+
+// What one scan saw, in the order of the beams or rays. Free cells are the
+// cells a beam or ray passed through, including the first cell outside of the
+// grid where it stopped, and hit cells the obstacles that stopped them. The
+// rays of a lidar often pass through the same cells near the robot, so a cell
+// can be listed more than once.
+struct SensorScan {
+    std::vector<Vector2> free_cells;
+    std::vector<Vector2> hit_cells;
+};
+
+// Casts the beams or rays of a sensor model through a world. Rays are traced
+// with the grid traversal of Amanatides and Woo, which steps from cell to
+// cell along the ray, so a ray only costs a few additions per cell it passes.
+class RangeSensor {
+private:
+    SensorModel m_model;
+    // The directions of the lidar rays for orientation zero
+    std::vector<double> m_ray_directions_x;
+    std::vector<double> m_ray_directions_y;
+    void cast_beam(const OccupancyGrid&, Vector2 position, Vector2 step, SensorScan&) const;
+    void cast_ray(const OccupancyGrid&, Vector2 position, double direction_x, double direction_y,
+                  SensorScan&) const;
+public:
+    RangeSensor();
+    void set_model(const SensorModel&);
+    const SensorModel& get_model() const;
+    // Replaces the contents of the scan with what a robot at the position,
+    // facing the orientation, senses in the world
+    void scan(const OccupancyGrid& world, Vector2 position, int orientation, SensorScan&) const;
+};
+
+// End header guard
+#endif
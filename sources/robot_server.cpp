@@ -3,7 +3,7 @@
 #include "robot_server.h"
 #include "application.h"
 
-RobotServer::RobotServer(Application& a) : m_app(a)
+RobotServer::RobotServer(Application& a, int robot) : m_app(a), m_robot(robot)
 {
 }
 
@@ -11,8 +11,8 @@ SensorData RobotServer::read_sensor()
 {
     SensorData data = {false, false, false};
 
-    Vector2 position = m_app.get_robot_position();
-    int orientation = m_app.get_robot_orientation();
+    Vector2 position = m_app.get_robot_position(m_robot);
+    int orientation = m_app.get_robot_orientation(m_robot);
 
     Vector2 absolute_top = position + Vector2(0, 1);
     Vector2 absolute_left = position + Vector2(-1, 0);
@@ -44,62 +44,68 @@ SensorData RobotServer::read_sensor()
         break;
     }
 
-    const std::vector<Vector2>& obstacles = m_app.get_obstacles();
-
-    for (Vector2 obstacle : obstacles) {
-        if (obstacle == left) {
-            data.left = true;
-        } else if (obstacle == front) {
-            data.front = true;
-        } else if (obstacle == right) {
-            data.right = true;
-        }
-    }
+    data.left = m_app.is_obstacle(left);
+    data.front = m_app.is_obstacle(front);
+    data.right = m_app.is_obstacle(right);
 
     return data;
 }
 
+const SensorScan& RobotServer::read_scan()
+{
+    m_app.scan(m_scan, m_robot);
+    return m_scan;
+}
+
 void RobotServer::turn_left()
 {
-    int orientation = m_app.get_robot_orientation();
-    m_app.set_robot_orientation((orientation + 1) % 4);
+    int orientation = m_app.get_robot_orientation(m_robot);
+    m_app.set_robot_orientation((orientation + 1) % 4, m_robot);
 }
 
 void RobotServer::move_forward()
 {
-    Vector2 position = m_app.get_robot_position();
-    int orientation = m_app.get_robot_orientation();
+    Vector2 position = m_app.get_robot_position(m_robot);
+    int orientation = m_app.get_robot_orientation(m_robot);
+    Vector2 next_position = position;
 
     switch (orientation) {
     case 0:
-        m_app.set_robot_position(position + Vector2(0, 1));
+        next_position = position + Vector2(0, 1);
         break;
     case 1:
-        m_app.set_robot_position(position + Vector2(-1, 0));
+        next_position = position + Vector2(-1, 0);
         break;
     case 2:
-        m_app.set_robot_position(position + Vector2(0, -1));
+        next_position = position + Vector2(0, -1);
         break;
     case 3:
-        m_app.set_robot_position(position + Vector2(1, 0));
+        next_position = position + Vector2(1, 0);
         break;
     }
+
+    // The robot cannot drive off the grid, into an obstacle or into another
+    // robot that has not stopped
+    if (m_app.is_in_grid(next_position) && !m_app.is_obstacle(next_position) &&
+        !m_app.is_other_robot_at(next_position, m_robot)) {
+        m_app.set_robot_position(next_position, m_robot);
+    }
 }
 
 void RobotServer::turn_right()
 {
-    int orientation = m_app.get_robot_orientation();
-    m_app.set_robot_orientation((orientation + 3) % 4);
+    int orientation = m_app.get_robot_orientation(m_robot);
+    m_app.set_robot_orientation((orientation + 3) % 4, m_robot);
 }
 
 Vector2 RobotServer::get_position()
 {
-    return m_app.get_robot_position();
+    return m_app.get_robot_position(m_robot);
 }
 
 int RobotServer::get_orientation()
 {
-    return m_app.get_robot_orientation();
+    return m_app.get_robot_orientation(m_robot);
 }
 
 int RobotServer::get_number_of_iterations()
@@ -122,7 +128,27 @@ int RobotServer::get_obstacle_amount()
     return m_app.get_obstacle_amount();
 }
 
+int RobotServer::get_robot_amount()
+{
+    return m_app.get_robot_amount();
+}
+
+const std::vector<Vector2>& RobotServer::get_plotted_obstacles()
+{
+    return m_app.get_found_obstacles();
+}
+
+const std::vector<Vector2>& RobotServer::get_plotted_seen_spaces()
+{
+    return m_app.get_seen_spaces();
+}
+
+int RobotServer::generate_random_number(int upper_bound)
+{
+    return m_app.get_random_generator(m_robot).next_below(upper_bound);
+}
+
 void RobotServer::stop()
 {
-    m_app.stop();
+    m_app.stop(m_robot);
 }
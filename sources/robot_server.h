@@ -4,6 +4,8 @@
 #define ROBOT_SERVER_H
 
 #include "data_types.h"
+#include "range_sensor.h"
+#include <vector>
 
 struct SensorData {
     bool left;
@@ -13,15 +15,22 @@ struct SensorData {
 
 class Application;
 
+// Serves one robot, the given one of the application's robots
 class RobotServer {
 private:
     Application& m_app;
+    int m_robot;
+    SensorScan m_scan;
 public:
     // Constructor
-    RobotServer(Application&);
+    RobotServer(Application&, int robot = 0);
     // Sensor read
     SensorData read_sensor();
-    // Movement
+    // Range sensor read, with the sensor model of the simulation. The scan
+    // is overwritten by the next read.
+    const SensorScan& read_scan();
+    // Movement. Robots cannot move into obstacles, out of the grid or into
+    // each other.
     void turn_left();
     void move_forward();
     void turn_right();
@@ -32,7 +41,16 @@ public:
     int get_grid_width();
     int get_grid_height();
     int get_obstacle_amount();
-    // Stop
+    // The amount of robots, and what all of them have plotted so far. Robots
+    // of a fleet share their map through these.
+    int get_robot_amount();
+    const std::vector<Vector2>& get_plotted_obstacles();
+    const std::vector<Vector2>& get_plotted_seen_spaces();
+    // Random number from zero up to, but not including, the upper bound,
+    // reproducible from the simulation's seed. Every robot draws from its own
+    // generator.
+    int generate_random_number(int upper_bound);
+    // Stop, which for a robot of a fleet only stops that robot
     void stop();
 };
 
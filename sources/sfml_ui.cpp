@@ -1,101 +1,335 @@
-
 // Includes
 #include "sfml_ui.h"
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <sstream>
+#include <string>
 
 // Global constants
 const sf::Vector2u WINDOW_SIZE = {1000, 1000};
 const char * const WINDOW_TITLE = "Robot Mapping Simulator";
+const unsigned int FRAMES_PER_SECOND = 60;
+// Limits of the step rate keys. Doubling past the maximum removes the limit.
+const double MINIMUM_STEPS_PER_SECOND = 0.25;
+const double MAXIMUM_STEPS_PER_SECOND = 100000;
+// Grid lines closer together than this many pixels are thinned out
+const float MINIMUM_GRID_LINE_SPACING = 4;
+// A simulation further behind its schedule than this stops catching up
+const std::chrono::milliseconds MAXIMUM_LAG(100);
+// Iterations the left and right keys seek a replay by
+const int SEEK_ITERATIONS = 1000;
+
+// Local function prototypes
+static float calculate_shape_radius(float cell_width, float cell_height);
+static void copy_new_positions(std::vector<Vector2>& copy, const std::vector<Vector2>& positions);
 
-SFMLUI::SFMLUI(const Parameters& parameters) : m_app(parameters)
+SFMLUI::SFMLUI(const Parameters& parameters, const SFMLOptions& options)
+    : m_app(parameters), m_steps_per_second(options.steps_per_second),
+      m_is_closing(false), m_is_snapshot_wanted(false), m_seek_offset(0),
+      m_obstacle_vertices(sf::Triangles), m_drawn_obstacle_amount(0),
+      m_path_vertices(sf::LineStrip)
 {
+    // Versions no application has, so that the first snapshot copies all
+    m_snapshot.plot_version = -1;
+    m_snapshot.path_version = -1;
+    m_drawn_snapshot.plot_version = -1;
+    m_drawn_snapshot.path_version = -1;
+
     m_window.create(sf::VideoMode(WINDOW_SIZE.x, WINDOW_SIZE.y), WINDOW_TITLE);
+    m_window.setFramerateLimit(FRAMES_PER_SECOND);
+    update_title();
+    publish_snapshot();
+    build_grid_lines();
 }
 
 int SFMLUI::run_loop()
 {
+    if (m_steps_per_second < 0) {
+        std::cerr << "Step rate is too small." << std::endl;
+        return 1;
+    }
+
+    m_simulation_thread = std::thread(&SFMLUI::run_simulation, this);
+
     while (m_window.isOpen()) {
         sf::Event event;
         while (m_window.pollEvent(event)) {
             if (event.type == sf::Event::Closed) {
                 m_window.close();
+            } else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Up) {
+                change_step_rate(true);
+            } else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Down) {
+                change_step_rate(false);
+            } else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Left) {
+                m_seek_offset -= SEEK_ITERATIONS;
+            } else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Right) {
+                m_seek_offset += SEEK_ITERATIONS;
             }
         }
-        m_app.step_through();
-        sf::sleep(sf::milliseconds(100));
-        // Draw
+
+        // Take the latest snapshot and ask for a new one
+        copy_snapshot();
+        m_is_snapshot_wanted = true;
+
+        // Draw, with one draw call each for the grid, path, robot and
+        // obstacles
         m_window.clear(sf::Color(170, 170, 170));
-        draw_grid_lines();
+        m_window.draw(m_grid_lines);
+        m_window.draw(m_path_vertices);
         draw_robot();
-        draw_obstacles();
+        m_window.draw(m_obstacle_vertices);
         m_window.display();
     }
+
+    m_is_closing = true;
+    m_simulation_thread.join();
     return 0;
 }
 
-void SFMLUI::draw_grid_lines()
+void SFMLUI::run_simulation()
 {
-    // Create vector of vertices, every two verticies is a single grid line
-    std::vector<sf::Vertex> lines;
-    lines.reserve((m_app.get_grid_width() + m_app.get_grid_height()) * 2);
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point next_step_time = Clock::now();
+    double steps_per_second = 0;
 
-    // Populate lines vector
-    for (int i = 1; i < m_app.get_grid_width(); i++) {
-        float x = static_cast<float>(WINDOW_SIZE.x) / m_app.get_grid_width() * i;
-        lines.push_back(sf::Vertex(sf::Vector2f(x, 0)));
-        lines.push_back(sf::Vertex(sf::Vector2f(x, WINDOW_SIZE.y)));
+    // A replay keeps running after its end, so that it can be seeked back
+    while (!m_is_closing && (!m_app.has_stopped() || m_app.is_replaying())) {
+        int seek_offset = m_seek_offset.exchange(0);
+        if (seek_offset != 0) {
+            m_app.seek(m_app.get_number_of_iterations() + seek_offset);
+        }
+
+        if (m_is_snapshot_wanted) {
+            std::unique_lock<std::mutex> lock(m_snapshot_mutex, std::try_to_lock);
+            if (lock.owns_lock()) {
+                publish_snapshot();
+            }
+        }
+
+        if (m_app.has_stopped()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+
+        double new_steps_per_second = m_steps_per_second;
+
+        if (new_steps_per_second > 0) {
+            Clock::time_point now = Clock::now();
+            // Wait in short sleeps, so that closing the window, changing the
+            // rate or seeking takes effect quickly
+            if (now < next_step_time && new_steps_per_second == steps_per_second) {
+                std::this_thread::sleep_for(std::min<Clock::duration>(next_step_time - now,
+                                                                      std::chrono::milliseconds(10)));
+                continue;
+            }
+            if (new_steps_per_second != steps_per_second || now - next_step_time > MAXIMUM_LAG) {
+                next_step_time = now;
+            }
+            next_step_time += std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(1 / new_steps_per_second));
+        }
+        steps_per_second = new_steps_per_second;
+
+        m_app.step_through();
     }
-    for (int i = 1; i < m_app.get_grid_height(); i++) {
-        float y = static_cast<float>(WINDOW_SIZE.y) / m_app.get_grid_height() * i;
-        lines.push_back(sf::Vertex(sf::Vector2f(0, y)));
-        lines.push_back(sf::Vertex(sf::Vector2f(WINDOW_SIZE.x, y)));
+
+    // The final state is always shown
+    std::lock_guard<std::mutex> lock(m_snapshot_mutex);
+    publish_snapshot();
+}
+
+// Must be called with the snapshot mutex locked, unless the simulation thread
+// is not running
+void SFMLUI::publish_snapshot()
+{
+    m_snapshot.robots = m_app.get_robots();
+
+    if (m_snapshot.plot_version != m_app.get_plot_version()) {
+        copy_new_positions(m_snapshot.found_obstacles, m_app.get_found_obstacles());
+        if (m_snapshot.path_version != m_app.get_path_version()) {
+            m_snapshot.planned_path = m_app.get_planned_path();
+            m_snapshot.path_version = m_app.get_path_version();
+        }
+        m_snapshot.plot_version = m_app.get_plot_version();
     }
+    m_is_snapshot_wanted = false;
+}
 
-    // Set color of all grid lines
-    for (sf::Vertex& vertex : lines) {
-        vertex.color = sf::Color(70, 70, 70);
+// The lock is only held while copying what changed, so the simulation rarely
+// finds it taken
+void SFMLUI::copy_snapshot()
+{
+    bool has_path_changed = false;
+    {
+        std::lock_guard<std::mutex> lock(m_snapshot_mutex);
+        m_drawn_snapshot.robots = m_snapshot.robots;
+
+        if (m_drawn_snapshot.plot_version != m_snapshot.plot_version) {
+            copy_new_positions(m_drawn_snapshot.found_obstacles, m_snapshot.found_obstacles);
+            if (m_drawn_snapshot.path_version != m_snapshot.path_version) {
+                m_drawn_snapshot.planned_path = m_snapshot.planned_path;
+                m_drawn_snapshot.path_version = m_snapshot.path_version;
+                has_path_changed = true;
+            }
+            m_drawn_snapshot.plot_version = m_snapshot.plot_version;
+        }
     }
 
-    // Draw grid lines
-    m_window.draw(lines.data(), lines.size(), sf::Lines);
+    append_obstacles();
+    if (has_path_changed) {
+        build_path();
+    }
 }
 
-void SFMLUI::draw_robot()
+void SFMLUI::change_step_rate(bool is_faster)
 {
-    // Find radius
+    double steps_per_second = m_steps_per_second;
+
+    if (is_faster && steps_per_second > 0) {
+        steps_per_second *= 2;
+        if (steps_per_second > MAXIMUM_STEPS_PER_SECOND) {
+            steps_per_second = 0;
+        }
+    } else if (!is_faster && steps_per_second == 0) {
+        steps_per_second = MAXIMUM_STEPS_PER_SECOND;
+    } else if (!is_faster) {
+        steps_per_second = std::max(steps_per_second / 2, MINIMUM_STEPS_PER_SECOND);
+    }
+
+    m_steps_per_second = steps_per_second;
+    update_title();
+}
+
+void SFMLUI::update_title()
+{
+    std::ostringstream title;
+    title << WINDOW_TITLE << " - ";
+    if (m_steps_per_second == 0) {
+        title << "unlimited";
+    } else {
+        title << m_steps_per_second;
+    }
+    title << " steps/s";
+    m_window.setTitle(title.str());
+}
+
+// Lines are only drawn every so many cells when cells are small, so that
+// they never cover more than a part of the window
+void SFMLUI::build_grid_lines()
+{
+    int grid_width = m_app.get_grid_width();
+    int grid_height = m_app.get_grid_height();
+    float cell_width = static_cast<float>(WINDOW_SIZE.x) / grid_width;
+    float cell_height = static_cast<float>(WINDOW_SIZE.y) / grid_height;
+
+    int line_spacing = 1;
+    while (std::min(cell_width, cell_height) * line_spacing < MINIMUM_GRID_LINE_SPACING) {
+        line_spacing *= 2;
+    }
+
+    // Every two vertices is a single grid line
+    m_grid_lines.clear();
+    m_grid_lines.setPrimitiveType(sf::Lines);
+    sf::Color color(70, 70, 70);
+    for (int i = line_spacing; i < grid_width; i += line_spacing) {
+        float x = cell_width * i;
+        m_grid_lines.append(sf::Vertex(sf::Vector2f(x, 0), color));
+        m_grid_lines.append(sf::Vertex(sf::Vector2f(x, WINDOW_SIZE.y), color));
+    }
+    for (int i = line_spacing; i < grid_height; i += line_spacing) {
+        float y = cell_height * i;
+        m_grid_lines.append(sf::Vertex(sf::Vector2f(0, y), color));
+        m_grid_lines.append(sf::Vertex(sf::Vector2f(WINDOW_SIZE.x, y), color));
+    }
+}
+
+// Adds the obstacles found since the last frame to the obstacle vertices, as
+// two triangles each. Algorithms only ever add found obstacles, so the ones
+// already in the array are a prefix of the snapshot's.
+void SFMLUI::append_obstacles()
+{
+    const std::vector<Vector2>& obstacles = m_drawn_snapshot.found_obstacles;
+
+    if (obstacles.size() < m_drawn_obstacle_amount) {
+        m_obstacle_vertices.clear();
+        m_drawn_obstacle_amount = 0;
+    }
+
     float cell_width = static_cast<float>(WINDOW_SIZE.x) / m_app.get_grid_width();
     float cell_height = static_cast<float>(WINDOW_SIZE.y) / m_app.get_grid_height();
-    float radius = std::min(cell_width / 2, cell_height / 2) - 20;
-
-    // Find x and y values
-    float x = (m_app.get_robot_position().x + 0.5) * cell_width;
-    float y = WINDOW_SIZE.y - (m_app.get_robot_position().y + 0.5) * cell_height;
-
-    // Draw triangle
-    sf::CircleShape robot(radius, 3);
-    robot.setPosition(x, y);
-    robot.setOrigin(radius, radius);
-    robot.setRotation(m_app.get_robot_orientation() * -90);
-    robot.setFillColor(sf::Color(70, 70, 170));
-    m_window.draw(robot);
+    float radius = calculate_shape_radius(cell_width, cell_height);
+    sf::Color color(170, 70, 70);
+
+    for (std::size_t i = m_drawn_obstacle_amount; i < obstacles.size(); i++) {
+        float x = (obstacles[i].x + 0.5) * cell_width;
+        float y = WINDOW_SIZE.y - (obstacles[i].y + 0.5) * cell_height;
+
+        sf::Vertex top(sf::Vector2f(x, y - radius), color);
+        sf::Vertex right(sf::Vector2f(x + radius, y), color);
+        sf::Vertex bottom(sf::Vector2f(x, y + radius), color);
+        sf::Vertex left(sf::Vector2f(x - radius, y), color);
+        m_obstacle_vertices.append(top);
+        m_obstacle_vertices.append(right);
+        m_obstacle_vertices.append(bottom);
+        m_obstacle_vertices.append(top);
+        m_obstacle_vertices.append(bottom);
+        m_obstacle_vertices.append(left);
+    }
+    m_drawn_obstacle_amount = obstacles.size();
 }
 
-void SFMLUI::draw_obstacles()
+void SFMLUI::build_path()
+{
+    float cell_width = static_cast<float>(WINDOW_SIZE.x) / m_app.get_grid_width();
+    float cell_height = static_cast<float>(WINDOW_SIZE.y) / m_app.get_grid_height();
+    sf::Color color(70, 70, 170);
+
+    m_path_vertices.clear();
+    for (Vector2 position : m_drawn_snapshot.planned_path) {
+        float x = (position.x + 0.5) * cell_width;
+        float y = WINDOW_SIZE.y - (position.y + 0.5) * cell_height;
+        m_path_vertices.append(sf::Vertex(sf::Vector2f(x, y), color));
+    }
+}
+
+void SFMLUI::draw_robot()
 {
     // Find radius
     float cell_width = static_cast<float>(WINDOW_SIZE.x) / m_app.get_grid_width();
     float cell_height = static_cast<float>(WINDOW_SIZE.y) / m_app.get_grid_height();
-    float radius = std::min(cell_width / 2, cell_height / 2) - 20;
+    float radius = calculate_shape_radius(cell_width, cell_height);
+
+    sf::CircleShape shape(radius, 3);
+    shape.setOrigin(radius, radius);
+    shape.setFillColor(sf::Color(70, 70, 170));
 
-    for (Vector2 obstacle : m_app.get_found_obstacles()) {
+    for (const Robot& robot : m_drawn_snapshot.robots) {
         // Find x and y values
-        float x = (obstacle.x + 0.5) * cell_width;
-        float y = WINDOW_SIZE.y - (obstacle.y + 0.5) * cell_height;
+        float x = (robot.position.x + 0.5) * cell_width;
+        float y = WINDOW_SIZE.y - (robot.position.y + 0.5) * cell_height;
 
-        sf::CircleShape obstacle_shape(radius, 4);
-        obstacle_shape.setOrigin(radius, radius);
-        obstacle_shape.setPosition(x, y);
-        obstacle_shape.setFillColor(sf::Color(170, 70, 70));
-        m_window.draw(obstacle_shape);
+        // Draw triangle
+        shape.setPosition(x, y);
+        shape.setRotation(robot.orientation * -90);
+        m_window.draw(shape);
     }
 }
+
+// Positions lists of the application are only ever added to during a run, so
+// only the positions past the ones already copied are copied
+void copy_new_positions(std::vector<Vector2>& copy, const std::vector<Vector2>& positions)
+{
+    if (copy.size() > positions.size()) {
+        copy.clear();
+    }
+    copy.insert(copy.end(), positions.begin() + copy.size(), positions.end());
+}
+
+// Shapes keep a margin of 20 pixels to the cell border, which on small cells
+// would leave nothing, so they always fill at least half of the cell
+float calculate_shape_radius(float cell_width, float cell_height)
+{
+    float half_cell = std::min(cell_width / 2, cell_height / 2);
+    return std::max(half_cell - 20, half_cell / 2);
+}
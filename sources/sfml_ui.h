@@ -1,4 +1,3 @@
-
 // Begin header guard
 #ifndef SFML_UI_H
 #define SFML_UI_H
@@ -6,17 +5,63 @@
 // Includes
 #include "application.h"
 #include <SFML/Graphics.hpp>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct SFMLOptions {
+    // Zero means as fast as possible
+    int steps_per_second;
+};
+
+// What the render loop draws, copied from the application by the simulation
+// thread. Only what changed since the last copy is copied, as told by the
+// application's plot versions.
+struct SimulationSnapshot {
+    std::vector<Robot> robots;
+    std::vector<Vector2> found_obstacles;
+    std::vector<Vector2> planned_path;
+    unsigned long long plot_version;
+    unsigned long long path_version;
+};
 
+// The simulation runs on its own thread at the chosen step rate, which the
+// up and down keys double and halve, while the window is drawn at display
+// rate. Replays can also be seeked with the left and right keys. The
+// simulation only publishes a snapshot when the render loop asks for one and
+// the snapshot is not being drawn, so neither waits for the other.
 class SFMLUI {
 private:
     Application m_app;
     sf::RenderWindow m_window;
+    std::thread m_simulation_thread;
+    std::atomic<double> m_steps_per_second;
+    std::atomic<bool> m_is_closing;
+    std::atomic<bool> m_is_snapshot_wanted;
+    // Iterations to seek a replay by, added to by the left and right keys
+    std::atomic<int> m_seek_offset;
+    std::mutex m_snapshot_mutex;
+    SimulationSnapshot m_snapshot;
+    // Only used by the render loop. The grid lines are built once and the
+    // obstacle vertices appended to as obstacles are found.
+    SimulationSnapshot m_drawn_snapshot;
+    sf::VertexArray m_grid_lines;
+    sf::VertexArray m_obstacle_vertices;
+    std::size_t m_drawn_obstacle_amount;
+    sf::VertexArray m_path_vertices;
     // Helper functions
-    void draw_grid_lines();
+    void run_simulation();
+    void publish_snapshot();
+    void copy_snapshot();
+    void change_step_rate(bool is_faster);
+    void update_title();
+    void build_grid_lines();
+    void append_obstacles();
+    void build_path();
     void draw_robot();
-    void draw_obstacles();
 public:
-    SFMLUI(const Parameters&);
+    SFMLUI(const Parameters&, const SFMLOptions&);
     int run_loop();
 };
 
@@ -0,0 +1,73 @@
+// Includes
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(int thread_amount) : m_unfinished_task_amount(0), m_is_stopping(false)
+{
+    if (thread_amount < 1) {
+        thread_amount = std::thread::hardware_concurrency();
+    }
+    // hardware_concurrency can return zero if it does not know
+    if (thread_amount < 1) {
+        thread_amount = 1;
+    }
+    for (int i = 0; i < thread_amount; i++) {
+        m_workers.push_back(std::thread(&ThreadPool::work, this));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_is_stopping = true;
+    }
+    m_task_added.notify_all();
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::add_task(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push(task);
+        m_unfinished_task_amount++;
+    }
+    m_task_added.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_unfinished_task_amount > 0) {
+        m_task_finished.wait(lock);
+    }
+}
+
+int ThreadPool::get_thread_amount()
+{
+    return m_workers.size();
+}
+
+void ThreadPool::work()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_is_stopping || !m_tasks.empty()) {
+        if (m_tasks.empty()) {
+            m_task_added.wait(lock);
+        } else {
+            std::function<void()> task = m_tasks.front();
+            m_tasks.pop();
+
+            lock.unlock();
+            task();
+            lock.lock();
+
+            m_unfinished_task_amount--;
+            if (m_unfinished_task_amount == 0) {
+                m_task_finished.notify_all();
+            }
+        }
+    }
+}
@@ -0,0 +1,36 @@
+// Begin header guard
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+// Includes
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// A fixed amount of worker threads that run tasks in the order they were
+// added.
+class ThreadPool {
+private:
+    std::vector<std::thread> m_workers;
+    std::queue<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_task_added;
+    std::condition_variable m_task_finished;
+    int m_unfinished_task_amount;
+    bool m_is_stopping;
+    void work();
+public:
+    // A thread amount below one uses one thread per core
+    ThreadPool(int thread_amount);
+    ~ThreadPool();
+    void add_task(std::function<void()> task);
+    // Blocks until every added task has finished
+    void wait();
+    int get_thread_amount();
+};
+
+// End header guard
+#endif
@@ -0,0 +1,213 @@
+// Includes
+#include "tournament_runner.h"
+#include "memory_counter.h"
+#include "thread_pool.h"
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <ostream>
+
+// Local types
+struct Run {
+    Parameters parameters;
+    double obstacle_density;
+};
+
+struct RunResult {
+    int iterations;
+    bool has_completed;
+    double milliseconds;
+    long long peak_memory;
+};
+
+// The results of the runs, written in order as they come in
+struct ResultTable {
+    std::vector<RunResult> results;
+    std::vector<bool> has_finished;
+    int written_amount;
+    std::mutex mutex;
+};
+
+// Local function prototypes
+static std::vector<Run> create_runs(const Parameters&, const TournamentParameters&);
+static bool are_runs_valid(const std::vector<Run>&);
+static void run_runs(const std::vector<Run>&, int max_iterations, std::atomic<int>& next_run,
+                     ResultTable&, std::ostream&);
+static RunResult run_once(const Parameters&, int max_iterations);
+static void write_row(std::ostream&, const Run&, const RunResult&);
+
+int run_tournament(const Parameters& parameters, const BatchParameters& batch_parameters,
+                   const TournamentParameters& tournament_parameters)
+{
+    if (!parameters.record_file.empty() || !parameters.replay_file.empty() ||
+        !parameters.map_file.empty() || !parameters.save_map_file.empty()) {
+        std::cerr << "Tournaments only run on generated worlds." << std::endl;
+        return 1;
+    }
+    if (tournament_parameters.algorithms.empty()) {
+        std::cerr << "The tournament has no algorithms." << std::endl;
+        return 1;
+    }
+    if (tournament_parameters.seed_amount < 1) {
+        std::cerr << "Seed amount is too small." << std::endl;
+        return 1;
+    }
+
+    std::vector<Run> runs = create_runs(parameters, tournament_parameters);
+    if (!are_runs_valid(runs)) {
+        return 1;
+    }
+    if (!is_memory_counted()) {
+        std::cerr << "Peak memory is unavailable, since this build does not count memory." << std::endl;
+    }
+
+    std::ofstream file;
+    if (!tournament_parameters.output_file.empty()) {
+        file.open(tournament_parameters.output_file);
+        if (!file) {
+            std::cerr << "Could not open " << tournament_parameters.output_file << "." << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = tournament_parameters.output_file.empty() ? std::cout : file;
+
+    out << "algorithm,grid_width,grid_height,obstacle_density,obstacle_amount,robots,seed,"
+        << "iterations,completed,milliseconds,peak_memory_bytes" << std::endl;
+
+    ResultTable table;
+    table.results.resize(runs.size());
+    table.has_finished.assign(runs.size(), false);
+    table.written_amount = 0;
+    std::atomic<int> next_run(0);
+    ThreadPool pool(batch_parameters.thread_amount);
+
+    for (int i = 0; i < pool.get_thread_amount(); i++) {
+        pool.add_task([&]() {
+            run_runs(runs, batch_parameters.max_iterations, next_run, table, out);
+        });
+    }
+    pool.wait();
+
+    if (!out) {
+        std::cerr << "Could not write the results." << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// The runs of one world are next to each other, one per algorithm, so that
+// the rows can be compared in pairs
+std::vector<Run> create_runs(const Parameters& parameters, const TournamentParameters& tournament_parameters)
+{
+    std::vector<Vector2> grid_sizes = tournament_parameters.grid_sizes;
+    if (grid_sizes.empty()) {
+        grid_sizes.push_back(Vector2(parameters.grid_width, parameters.grid_height));
+    }
+
+    std::vector<Run> runs;
+    for (Vector2 grid_size : grid_sizes) {
+        long long cell_amount = static_cast<long long>(grid_size.x) * grid_size.y;
+        std::vector<double> obstacle_densities = tournament_parameters.obstacle_densities;
+        if (obstacle_densities.empty()) {
+            obstacle_densities.push_back(static_cast<double>(parameters.obstacle_amount) / cell_amount);
+        }
+
+        for (double obstacle_density : obstacle_densities) {
+            for (int seed = 0; seed < tournament_parameters.seed_amount; seed++) {
+                for (const std::string& algorithm : tournament_parameters.algorithms) {
+                    Run run = {parameters, obstacle_density};
+                    run.parameters.grid_width = grid_size.x;
+                    run.parameters.grid_height = grid_size.y;
+                    run.parameters.algorithm = algorithm;
+                    run.parameters.seed = parameters.seed + seed;
+                    if (tournament_parameters.obstacle_densities.empty()) {
+                        run.parameters.obstacle_amount = parameters.obstacle_amount;
+                    } else {
+                        // Amounts too large for an int are too big for any
+                        // world that fits in memory, and are refused as such
+                        double obstacle_amount = cell_amount * obstacle_density;
+                        run.parameters.obstacle_amount = obstacle_amount < INT_MAX ? obstacle_amount : INT_MAX;
+                    }
+                    runs.push_back(run);
+                }
+            }
+        }
+    }
+    return runs;
+}
+
+// Checks every combination of algorithm, size and density once, before any
+// run starts. The seed makes no difference to whether a run is valid.
+bool are_runs_valid(const std::vector<Run>& runs)
+{
+    for (const Run& run : runs) {
+        if (run.parameters.seed == runs[0].parameters.seed) {
+            Application app(run.parameters);
+            if (app.has_stopped()) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void run_runs(const std::vector<Run>& runs, int max_iterations, std::atomic<int>& next_run,
+              ResultTable& table, std::ostream& out)
+{
+    int run = next_run++;
+    while (run < runs.size()) {
+        RunResult result = run_once(runs[run].parameters, max_iterations);
+
+        std::lock_guard<std::mutex> lock(table.mutex);
+        table.results[run] = result;
+        table.has_finished[run] = true;
+        while (table.written_amount < runs.size() && table.has_finished[table.written_amount]) {
+            write_row(out, runs[table.written_amount], table.results[table.written_amount]);
+            table.written_amount++;
+        }
+
+        run = next_run++;
+    }
+}
+
+// Every run has its own application, so that the peak memory of the run
+// includes the world and the algorithm state
+RunResult run_once(const Parameters& parameters, int max_iterations)
+{
+    long long start_memory = get_allocated_memory();
+    reset_peak_memory();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    RunResult result;
+    {
+        Application app(parameters);
+        app.set_quiet(true);
+        // The runs already keep every core busy
+        app.set_parallel(false);
+        app.run_headless(max_iterations);
+        result.iterations = app.get_number_of_iterations();
+        result.has_completed = app.has_stopped();
+    }
+
+    std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+    result.milliseconds = time.count();
+    result.peak_memory = get_peak_memory() - start_memory;
+    return result;
+}
+
+void write_row(std::ostream& out, const Run& run, const RunResult& result)
+{
+    const Parameters& parameters = run.parameters;
+    out << parameters.algorithm << ',' << parameters.grid_width << ',' << parameters.grid_height << ','
+        << run.obstacle_density << ',' << parameters.obstacle_amount << ',' << parameters.robot_amount << ','
+        << parameters.seed << ',' << result.iterations << ',' << (result.has_completed ? 1 : 0) << ','
+        << result.milliseconds << ',';
+    // Builds that do not count memory leave the peak memory empty
+    if (is_memory_counted()) {
+        out << result.peak_memory;
+    }
+    out << std::endl;
+}
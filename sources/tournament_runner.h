@@ -0,0 +1,31 @@
+// Begin header guard
+#ifndef TOURNAMENT_RUNNER_H
+#define TOURNAMENT_RUNNER_H
+
+// Includes
+#include "application.h"
+#include "batch_runner.h"
+#include <string>
+#include <vector>
+
+struct TournamentParameters {
+    std::vector<std::string> algorithms;
+    // Grid sizes and obstacle densities to sweep. Without any, the size and
+    // obstacle amount of the parameters are used.
+    std::vector<Vector2> grid_sizes;
+    std::vector<double> obstacle_densities;
+    // Runs use this many seeds, counting up from the seed of the parameters
+    int seed_amount;
+    // Where to write the results, the standard output if empty
+    std::string output_file;
+};
+
+// Runs every algorithm on every combination of grid size, obstacle density
+// and seed, in parallel like a batch. The world of a run only depends on its
+// size, density and seed, so every algorithm is run on exactly the same
+// worlds. Writes one CSV row per run, in the order of the runs, as soon as
+// the runs before it have finished.
+int run_tournament(const Parameters&, const BatchParameters&, const TournamentParameters&);
+
+// End header guard
+#endif
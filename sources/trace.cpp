@@ -0,0 +1,450 @@
+// Includes
+#include "trace.h"
+#include <cstring>
+
+// Local constants
+static const char HEADER_MAGIC[4] = {'R', 'M', 'S', 'T'};
+static const char FOOTER_MAGIC[4] = {'R', 'M', 'S', 'K'};
+static const int FORMAT_VERSION = 1;
+static const int FOOTER_END_SIZE = 12;
+static const std::size_t BUFFER_SIZE = 1 << 16;
+static const unsigned char ORIENTATION_BITS = 0x03;
+static const unsigned char LEFT_BIT = 0x04;
+static const unsigned char FRONT_BIT = 0x08;
+static const unsigned char RIGHT_BIT = 0x10;
+static const unsigned char MOVED_FORWARD_BIT = 0x20;
+static const unsigned char OBSTACLES_BIT = 0x40;
+static const unsigned char POSITION_BIT = 0x80;
+
+// Local function prototypes
+static Vector2 step_forward(Vector2, int orientation);
+static void append_varint(std::vector<unsigned char>&, unsigned long long);
+static void append_signed_varint(std::vector<unsigned char>&, long long);
+static bool read_varint(const unsigned char* data, long long end, long long& offset,
+                        unsigned long long& value);
+static bool read_signed_varint(const unsigned char* data, long long end, long long& offset,
+                               long long& value);
+static bool read_int(const unsigned char* data, long long end, long long& offset, int& value);
+static bool read_signed_int(const unsigned char* data, long long end, long long& offset, int& value);
+
+TraceWriter::TraceWriter() : m_file(nullptr)
+{
+}
+
+TraceWriter::~TraceWriter()
+{
+    finish();
+}
+
+bool TraceWriter::open(const std::string& path, const TraceHeader& header)
+{
+    finish();
+
+    m_file = std::fopen(path.c_str(), "wb");
+    if (m_file == nullptr) {
+        return false;
+    }
+
+    m_buffer.clear();
+    m_buffer.reserve(BUFFER_SIZE);
+    m_offset = 0;
+    m_keyframe_interval = header.keyframe_interval;
+    m_iteration = 0;
+    m_position = header.start_position;
+    m_orientation = header.start_orientation;
+    m_found_obstacle_amount = 0;
+    m_keyframes.clear();
+
+    m_buffer.insert(m_buffer.end(), HEADER_MAGIC, HEADER_MAGIC + 4);
+    append_varint(m_buffer, FORMAT_VERSION);
+    append_varint(m_buffer, header.grid_width);
+    append_varint(m_buffer, header.grid_height);
+    append_varint(m_buffer, header.obstacle_amount);
+    append_varint(m_buffer, header.seed);
+    append_varint(m_buffer, header.algorithm.size());
+    m_buffer.insert(m_buffer.end(), header.algorithm.begin(), header.algorithm.end());
+    append_varint(m_buffer, header.keyframe_interval);
+    append_signed_varint(m_buffer, header.start_position.x);
+    append_signed_varint(m_buffer, header.start_position.y);
+    append_varint(m_buffer, header.start_orientation);
+    return true;
+}
+
+void TraceWriter::write_step(Vector2 position, int orientation, SensorData sensor_data,
+                             const std::vector<Vector2>& found_obstacles)
+{
+    if (m_file == nullptr) {
+        return;
+    }
+
+    if (m_iteration % m_keyframe_interval == 0) {
+        TraceKeyframe keyframe = {m_iteration, m_offset + static_cast<long long>(m_buffer.size()),
+                                  m_position, m_orientation, m_found_obstacle_amount};
+        m_keyframes.push_back(keyframe);
+    }
+
+    unsigned char flags = orientation & ORIENTATION_BITS;
+    if (sensor_data.left) {
+        flags |= LEFT_BIT;
+    }
+    if (sensor_data.front) {
+        flags |= FRONT_BIT;
+    }
+    if (sensor_data.right) {
+        flags |= RIGHT_BIT;
+    }
+    if (position != m_position) {
+        if (orientation == m_orientation && position == step_forward(m_position, orientation)) {
+            flags |= MOVED_FORWARD_BIT;
+        } else {
+            flags |= POSITION_BIT;
+        }
+    }
+    long long new_obstacle_amount = found_obstacles.size() - m_found_obstacle_amount;
+    if (new_obstacle_amount > 0) {
+        flags |= OBSTACLES_BIT;
+    }
+
+    m_buffer.push_back(flags);
+    if (flags & POSITION_BIT) {
+        append_signed_varint(m_buffer, position.x);
+        append_signed_varint(m_buffer, position.y);
+    }
+    if (flags & OBSTACLES_BIT) {
+        append_varint(m_buffer, new_obstacle_amount);
+        for (std::size_t i = m_found_obstacle_amount; i < found_obstacles.size(); i++) {
+            append_signed_varint(m_buffer, found_obstacles[i].x - position.x);
+            append_signed_varint(m_buffer, found_obstacles[i].y - position.y);
+        }
+        m_found_obstacle_amount = found_obstacles.size();
+    }
+
+    m_position = position;
+    m_orientation = orientation;
+    m_iteration++;
+
+    if (m_buffer.size() >= BUFFER_SIZE) {
+        flush();
+    }
+}
+
+void TraceWriter::finish()
+{
+    if (m_file == nullptr) {
+        return;
+    }
+
+    unsigned long long footer_offset = m_offset + m_buffer.size();
+    append_varint(m_buffer, m_keyframes.size());
+    for (const TraceKeyframe& keyframe : m_keyframes) {
+        append_varint(m_buffer, keyframe.iteration);
+        append_varint(m_buffer, keyframe.offset);
+        append_signed_varint(m_buffer, keyframe.position.x);
+        append_signed_varint(m_buffer, keyframe.position.y);
+        append_varint(m_buffer, keyframe.orientation);
+        append_varint(m_buffer, keyframe.found_obstacle_amount);
+    }
+    append_varint(m_buffer, m_iteration);
+    for (int i = 0; i < 8; i++) {
+        m_buffer.push_back(footer_offset >> (i * 8));
+    }
+    m_buffer.insert(m_buffer.end(), FOOTER_MAGIC, FOOTER_MAGIC + 4);
+
+    flush();
+    std::fclose(m_file);
+    m_file = nullptr;
+}
+
+void TraceWriter::flush()
+{
+    std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file);
+    m_offset += m_buffer.size();
+    m_buffer.clear();
+}
+
+TraceReader::TraceReader() : m_data_start(0), m_data_end(0), m_offset(0), m_iteration(0)
+{
+}
+
+bool TraceReader::open(const std::string& path)
+{
+    if (!m_file.open(path)) {
+        return false;
+    }
+
+    const unsigned char* data = m_file.get_data();
+    long long size = m_file.get_size();
+    long long offset = sizeof(HEADER_MAGIC);
+    int version;
+    unsigned long long algorithm_length;
+
+    if (size < offset || std::memcmp(data, HEADER_MAGIC, sizeof(HEADER_MAGIC)) != 0 ||
+        !read_int(data, size, offset, version) || version != FORMAT_VERSION ||
+        !read_int(data, size, offset, m_header.grid_width) ||
+        !read_int(data, size, offset, m_header.grid_height) ||
+        !read_int(data, size, offset, m_header.obstacle_amount) ||
+        !read_varint(data, size, offset, m_header.seed) ||
+        !read_varint(data, size, offset, algorithm_length) ||
+        algorithm_length > static_cast<unsigned long long>(size - offset)) {
+        return false;
+    }
+    m_header.algorithm.assign(reinterpret_cast<const char*>(data + offset), algorithm_length);
+    offset += algorithm_length;
+    if (!read_int(data, size, offset, m_header.keyframe_interval) ||
+        !read_signed_int(data, size, offset, m_header.start_position.x) ||
+        !read_signed_int(data, size, offset, m_header.start_position.y) ||
+        !read_int(data, size, offset, m_header.start_orientation)) {
+        return false;
+    }
+    m_data_start = offset;
+
+    if (!read_footer()) {
+        return false;
+    }
+
+    m_offset = m_data_start;
+    m_iteration = 0;
+    m_position = m_header.start_position;
+    m_orientation = m_header.start_orientation;
+    m_sensor_data = SensorData{false, false, false};
+    m_found_obstacles.clear();
+    return true;
+}
+
+// A missing footer is fine, the trace was cut short, but a broken one is not
+bool TraceReader::read_footer()
+{
+    const unsigned char* data = m_file.get_data();
+    long long size = m_file.get_size();
+
+    m_keyframes.clear();
+    m_data_end = size;
+
+    if (size - m_data_start < FOOTER_END_SIZE ||
+        std::memcmp(data + size - sizeof(FOOTER_MAGIC), FOOTER_MAGIC, sizeof(FOOTER_MAGIC)) != 0) {
+        return true;
+    }
+
+    unsigned long long footer_offset = 0;
+    for (int i = 0; i < 8; i++) {
+        footer_offset |= static_cast<unsigned long long>(data[size - FOOTER_END_SIZE + i]) << (i * 8);
+    }
+    long long footer_end = size - FOOTER_END_SIZE;
+    if (footer_offset < static_cast<unsigned long long>(m_data_start) ||
+        footer_offset > static_cast<unsigned long long>(footer_end)) {
+        return false;
+    }
+
+    long long offset = footer_offset;
+    unsigned long long keyframe_amount;
+    if (!read_varint(data, footer_end, offset, keyframe_amount)) {
+        return false;
+    }
+    for (unsigned long long i = 0; i < keyframe_amount; i++) {
+        TraceKeyframe keyframe;
+        unsigned long long iteration;
+        unsigned long long keyframe_offset;
+        unsigned long long found_obstacle_amount;
+        if (!read_varint(data, footer_end, offset, iteration) ||
+            !read_varint(data, footer_end, offset, keyframe_offset) ||
+            !read_signed_int(data, footer_end, offset, keyframe.position.x) ||
+            !read_signed_int(data, footer_end, offset, keyframe.position.y) ||
+            !read_int(data, footer_end, offset, keyframe.orientation) ||
+            !read_varint(data, footer_end, offset, found_obstacle_amount) ||
+            keyframe_offset < static_cast<unsigned long long>(m_data_start) ||
+            keyframe_offset > footer_offset) {
+            return false;
+        }
+        keyframe.iteration = iteration;
+        keyframe.offset = keyframe_offset;
+        keyframe.found_obstacle_amount = found_obstacle_amount;
+        m_keyframes.push_back(keyframe);
+    }
+
+    m_data_end = footer_offset;
+    return true;
+}
+
+const TraceHeader& TraceReader::get_header() const
+{
+    return m_header;
+}
+
+bool TraceReader::has_next() const
+{
+    return m_offset < m_data_end;
+}
+
+bool TraceReader::read_step()
+{
+    if (!has_next()) {
+        return false;
+    }
+
+    const unsigned char* data = m_file.get_data();
+    long long offset = m_offset;
+    unsigned char flags = data[offset++];
+    int orientation = flags & ORIENTATION_BITS;
+    Vector2 position = m_position;
+    std::size_t old_found_obstacle_amount = m_found_obstacles.size();
+
+    if (flags & POSITION_BIT) {
+        if (!read_signed_int(data, m_data_end, offset, position.x) ||
+            !read_signed_int(data, m_data_end, offset, position.y)) {
+            return false;
+        }
+    } else if (flags & MOVED_FORWARD_BIT) {
+        position = step_forward(position, orientation);
+    }
+
+    if (flags & OBSTACLES_BIT) {
+        unsigned long long amount;
+        if (!read_varint(data, m_data_end, offset, amount)) {
+            return false;
+        }
+        for (unsigned long long i = 0; i < amount; i++) {
+            Vector2 relative;
+            if (!read_signed_int(data, m_data_end, offset, relative.x) ||
+                !read_signed_int(data, m_data_end, offset, relative.y)) {
+                m_found_obstacles.resize(old_found_obstacle_amount);
+                return false;
+            }
+            m_found_obstacles.push_back(position + relative);
+        }
+    }
+
+    m_offset = offset;
+    m_iteration++;
+    m_position = position;
+    m_orientation = orientation;
+    m_sensor_data.left = flags & LEFT_BIT;
+    m_sensor_data.front = flags & FRONT_BIT;
+    m_sensor_data.right = flags & RIGHT_BIT;
+    return true;
+}
+
+void TraceReader::seek(long long iteration)
+{
+    if (iteration < m_iteration) {
+        // Start over from the last keyframe before the iteration, so that at
+        // least one record is read and the sensor data is known
+        TraceKeyframe start = {0, m_data_start, m_header.start_position,
+                               m_header.start_orientation, 0};
+        for (const TraceKeyframe& keyframe : m_keyframes) {
+            if (keyframe.iteration < iteration && keyframe.iteration > start.iteration) {
+                start = keyframe;
+            }
+        }
+
+        m_offset = start.offset;
+        m_iteration = start.iteration;
+        m_position = start.position;
+        m_orientation = start.orientation;
+        m_sensor_data = SensorData{false, false, false};
+        m_found_obstacles.resize(start.found_obstacle_amount);
+    }
+
+    while (m_iteration < iteration && read_step()) {
+    }
+}
+
+long long TraceReader::get_iteration() const
+{
+    return m_iteration;
+}
+
+Vector2 TraceReader::get_position() const
+{
+    return m_position;
+}
+
+int TraceReader::get_orientation() const
+{
+    return m_orientation;
+}
+
+SensorData TraceReader::get_sensor_data() const
+{
+    return m_sensor_data;
+}
+
+const std::vector<Vector2>& TraceReader::get_found_obstacles() const
+{
+    return m_found_obstacles;
+}
+
+// Same as the robot server's forward move
+Vector2 step_forward(Vector2 position, int orientation)
+{
+    switch (orientation) {
+    case 0:
+        return position + Vector2(0, 1);
+    case 1:
+        return position + Vector2(-1, 0);
+    case 2:
+        return position + Vector2(0, -1);
+    default:
+        return position + Vector2(1, 0);
+    }
+}
+
+void append_varint(std::vector<unsigned char>& buffer, unsigned long long value)
+{
+    while (value >= 0x80) {
+        buffer.push_back((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    buffer.push_back(value);
+}
+
+// Zigzag encoding maps small negative numbers to small positive ones
+void append_signed_varint(std::vector<unsigned char>& buffer, long long value)
+{
+    append_varint(buffer, (static_cast<unsigned long long>(value) << 1) ^ (value < 0 ? ~0ULL : 0));
+}
+
+bool read_varint(const unsigned char* data, long long end, long long& offset,
+                 unsigned long long& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && offset < end; shift += 7) {
+        unsigned char byte = data[offset++];
+        value |= static_cast<unsigned long long>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool read_signed_varint(const unsigned char* data, long long end, long long& offset,
+                        long long& value)
+{
+    unsigned long long encoded;
+    if (!read_varint(data, end, offset, encoded)) {
+        return false;
+    }
+    value = static_cast<long long>(encoded >> 1) ^ -static_cast<long long>(encoded & 1);
+    return true;
+}
+
+bool read_int(const unsigned char* data, long long end, long long& offset, int& value)
+{
+    unsigned long long encoded;
+    if (!read_varint(data, end, offset, encoded) || encoded > 0x7fffffff) {
+        return false;
+    }
+    value = encoded;
+    return true;
+}
+
+bool read_signed_int(const unsigned char* data, long long end, long long& offset, int& value)
+{
+    long long decoded;
+    if (!read_signed_varint(data, end, offset, decoded) || decoded < -0x7fffffffLL ||
+        decoded > 0x7fffffffLL) {
+        return false;
+    }
+    value = decoded;
+    return true;
+}
@@ -0,0 +1,119 @@
+// Begin header guard
+#ifndef TRACE_H
+#define TRACE_H
+
+// Includes
+#include "data_types.h"
+#include "mapped_file.h"
+#include "robot_server.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// A trace is a recording of a run, one record per iteration. All numbers are
+// LEB128 varints, signed ones zigzag encoded first.
+//
+// Header: the bytes "RMST", the format version, grid width, grid height,
+// obstacle amount, seed, length and characters of the algorithm name,
+// keyframe interval and the robot's starting x, y and orientation.
+//
+// Record: one byte holding the robot's orientation after the step (bits 0-1),
+// the sensor bits at that pose (bits 2-4, left, front and right), whether the
+// robot moved one space forward (bit 5), whether obstacles were found (bit 6)
+// and whether an absolute position follows (bit 7). Then the x and y of the
+// position if bit 7 is set, and if bit 6 is set the amount of new obstacles
+// and each obstacle's x and y relative to the robot. Most records are a
+// single byte.
+//
+// Footer, written when the recording ends: the keyframes, each holding the
+// iteration, the offset of the record after it, the robot pose and the
+// amount of found obstacles, then the amount of records, the offset of the
+// footer as 8 little endian bytes, and the bytes "RMSK". A trace cut short
+// has no footer, and can still be replayed but not seeked quickly.
+
+struct TraceHeader {
+    int grid_width;
+    int grid_height;
+    int obstacle_amount;
+    unsigned long long seed;
+    std::string algorithm;
+    int keyframe_interval;
+    Vector2 start_position;
+    int start_orientation;
+};
+
+struct TraceKeyframe {
+    long long iteration;
+    long long offset;
+    Vector2 position;
+    int orientation;
+    long long found_obstacle_amount;
+};
+
+// Streams records to a file through a buffer
+class TraceWriter {
+private:
+    std::FILE* m_file;
+    std::vector<unsigned char> m_buffer;
+    long long m_offset;
+    int m_keyframe_interval;
+    long long m_iteration;
+    Vector2 m_position;
+    int m_orientation;
+    long long m_found_obstacle_amount;
+    std::vector<TraceKeyframe> m_keyframes;
+    void flush();
+public:
+    TraceWriter();
+    ~TraceWriter();
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+    // Returns whether the file could be opened for writing
+    bool open(const std::string& path, const TraceHeader&);
+    // Records one iteration. Found obstacles may only be added to, the ones
+    // past those of the last record are recorded as new.
+    void write_step(Vector2 position, int orientation, SensorData,
+                    const std::vector<Vector2>& found_obstacles);
+    // Writes the footer and closes the file, also done on destruction
+    void finish();
+};
+
+// Reads a memory mapped trace one record at a time
+class TraceReader {
+private:
+    MappedFile m_file;
+    TraceHeader m_header;
+    long long m_data_start;
+    long long m_data_end;
+    std::vector<TraceKeyframe> m_keyframes;
+    // Decoding state, the state after m_iteration records
+    long long m_offset;
+    long long m_iteration;
+    Vector2 m_position;
+    int m_orientation;
+    SensorData m_sensor_data;
+    std::vector<Vector2> m_found_obstacles;
+    bool read_footer();
+public:
+    TraceReader();
+    // Returns whether the file is a trace
+    bool open(const std::string& path);
+    const TraceHeader& get_header() const;
+    bool has_next() const;
+    // Reads the next record, returns false if it is missing or broken
+    bool read_step();
+    // Moves to the state after the given amount of records, or the last
+    // record if there are fewer. Keyframes make seeking back take at most a
+    // keyframe interval of records; seeking forward decodes the records in
+    // between, which have to be read for their obstacles anyway.
+    void seek(long long iteration);
+    long long get_iteration() const;
+    Vector2 get_position() const;
+    int get_orientation() const;
+    SensorData get_sensor_data() const;
+    // Obstacles found up to the current record, in the order they were found
+    const std::vector<Vector2>& get_found_obstacles() const;
+};
+
+// End header guard
+#endif
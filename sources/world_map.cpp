@@ -0,0 +1,300 @@
+// Includes
+#include "world_map.h"
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Local constants
+static const char MAP_MAGIC[4] = {'R', 'M', 'S', 'M'};
+static const unsigned long long MAP_VERSION = 1;
+static const long long MAP_HEADER_SIZE = 24;
+// The bytes written at once when saving a tiled grid
+static const long long SAVE_BLOCK_SIZE = 1 << 16;
+// The characters of saved text maps
+static const char TEXT_FREE = '.';
+static const char TEXT_OBSTACLE = '*';
+
+// Local function prototypes
+static bool load_binary_map(const MappedFile&, OccupancyGrid&, long long& obstacle_amount);
+static bool load_pgm_map(const MappedFile&, OccupancyGrid&, long long& obstacle_amount);
+static bool load_text_map(const MappedFile&, OccupancyGrid&, long long& obstacle_amount);
+static bool read_pgm_number(const unsigned char* data, long long size, long long& offset,
+                            long long& value);
+static bool is_valid_size(long long width, long long height);
+static unsigned long long read_little_endian(const unsigned char* data, int byte_amount);
+static void append_little_endian(std::string&, unsigned long long value, int byte_amount);
+static bool ends_with(const std::string&, const std::string& suffix);
+
+bool load_map(const std::string& path, MappedFile& file, OccupancyGrid& grid,
+              long long& obstacle_amount)
+{
+    if (!file.open(path)) {
+        return false;
+    }
+
+    const unsigned char* data = file.get_data();
+    std::size_t size = file.get_size();
+
+    if (size >= sizeof(MAP_MAGIC) && std::memcmp(data, MAP_MAGIC, sizeof(MAP_MAGIC)) == 0) {
+        return load_binary_map(file, grid, obstacle_amount);
+    }
+
+    bool has_loaded;
+    if (size >= 2 && data[0] == 'P' && (data[1] == '2' || data[1] == '5')) {
+        has_loaded = load_pgm_map(file, grid, obstacle_amount);
+    } else {
+        has_loaded = load_text_map(file, grid, obstacle_amount);
+    }
+
+    // Images and text are copied into the grid, so the file is not needed
+    file.close();
+    return has_loaded;
+}
+
+bool save_map(const std::string& path, const OccupancyGrid& grid)
+{
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    int width = grid.get_width();
+    int height = grid.get_height();
+    std::string buffer;
+
+    if (ends_with(path, ".txt") || ends_with(path, ".pgm")) {
+        bool is_text = ends_with(path, ".txt");
+        char free = is_text ? TEXT_FREE : static_cast<char>(255);
+        char obstacle = is_text ? TEXT_OBSTACLE : 0;
+
+        if (!is_text) {
+            buffer = "P5\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+            std::fwrite(buffer.data(), 1, buffer.size(), file);
+        }
+
+        // One write per row, top row first
+        for (int y = height - 1; y >= 0; y--) {
+            buffer.clear();
+            for (int x = 0; x < width; x++) {
+                buffer += grid.is_occupied(Vector2(x, y)) ? obstacle : free;
+            }
+            if (is_text) {
+                buffer += '\n';
+            }
+            std::fwrite(buffer.data(), 1, buffer.size(), file);
+        }
+    } else {
+        buffer.assign(MAP_MAGIC, sizeof(MAP_MAGIC));
+        append_little_endian(buffer, MAP_VERSION, 4);
+        append_little_endian(buffer, width, 4);
+        append_little_endian(buffer, height, 4);
+        append_little_endian(buffer, grid.count_occupied(), 8);
+        std::fwrite(buffer.data(), 1, buffer.size(), file);
+
+        if (grid.get_bits() != nullptr) {
+            std::fwrite(grid.get_bits(), 1, grid.get_byte_size(), file);
+        } else {
+            // Tiled grids are mostly free, so the bits are written from the
+            // occupied cells, a block of bytes at a time
+            std::vector<Vector2> cells;
+            grid.append_occupied_cells(cells);
+
+            std::vector<unsigned char> block(SAVE_BLOCK_SIZE, 0);
+            long long block_start = 0;
+            for (Vector2 cell : cells) {
+                long long index = static_cast<long long>(cell.y) * width + cell.x;
+                while (index / 8 >= block_start + SAVE_BLOCK_SIZE) {
+                    std::fwrite(block.data(), 1, block.size(), file);
+                    std::fill(block.begin(), block.end(), 0);
+                    block_start += SAVE_BLOCK_SIZE;
+                }
+                block[index / 8 - block_start] |= 1 << (index & 7);
+            }
+            for (; block_start < grid.get_byte_size(); block_start += SAVE_BLOCK_SIZE) {
+                std::fwrite(block.data(), 1, std::min(SAVE_BLOCK_SIZE, grid.get_byte_size() - block_start), file);
+                std::fill(block.begin(), block.end(), 0);
+            }
+        }
+    }
+
+    bool has_failed = std::ferror(file) != 0;
+    if (std::fclose(file) != 0) {
+        has_failed = true;
+    }
+    return !has_failed;
+}
+
+bool load_binary_map(const MappedFile& file, OccupancyGrid& grid, long long& obstacle_amount)
+{
+    const unsigned char* data = file.get_data();
+    long long size = file.get_size();
+
+    if (size < MAP_HEADER_SIZE || read_little_endian(data + 4, 4) != MAP_VERSION) {
+        return false;
+    }
+
+    long long width = read_little_endian(data + 8, 4);
+    long long height = read_little_endian(data + 12, 4);
+    unsigned long long amount = read_little_endian(data + 16, 8);
+    if (!is_valid_size(width, height) || amount >= static_cast<unsigned long long>(width * height) ||
+        size - MAP_HEADER_SIZE < (width * height + 7) / 8) {
+        return false;
+    }
+
+    // The amount decides when a run has found every obstacle, so a file whose
+    // header does not match its bits would make runs stop early or never
+    grid.view(width, height, data + MAP_HEADER_SIZE);
+    if (grid.count_occupied() != static_cast<long long>(amount)) {
+        grid.reset(0, 0);
+        return false;
+    }
+    obstacle_amount = amount;
+    return true;
+}
+
+bool load_pgm_map(const MappedFile& file, OccupancyGrid& grid, long long& obstacle_amount)
+{
+    const unsigned char* data = file.get_data();
+    long long size = file.get_size();
+    bool is_raw = data[1] == '5';
+    long long offset = 2;
+    long long width;
+    long long height;
+    long long maximum_value;
+
+    if (!read_pgm_number(data, size, offset, width) || !read_pgm_number(data, size, offset, height) ||
+        !read_pgm_number(data, size, offset, maximum_value) || !is_valid_size(width, height) ||
+        maximum_value < 1 || maximum_value > 65535) {
+        return false;
+    }
+
+    // Raw pixels follow a single whitespace character, in one or two bytes
+    int sample_size = maximum_value < 256 ? 1 : 2;
+    if (is_raw) {
+        offset++;
+        if (offset > size || (size - offset) / sample_size / width < height) {
+            return false;
+        }
+    }
+
+    grid.reset(width, height);
+    obstacle_amount = 0;
+    for (int y = height - 1; y >= 0; y--) {
+        for (int x = 0; x < width; x++) {
+            long long value;
+            if (is_raw) {
+                value = data[offset];
+                if (sample_size == 2) {
+                    value = value << 8 | data[offset + 1];
+                }
+                offset += sample_size;
+            } else if (!read_pgm_number(data, size, offset, value)) {
+                return false;
+            }
+
+            if (value * 2 < maximum_value) {
+                grid.set_occupied(Vector2(x, y), true);
+                obstacle_amount++;
+            }
+        }
+    }
+    return true;
+}
+
+bool load_text_map(const MappedFile& file, OccupancyGrid& grid, long long& obstacle_amount)
+{
+    const unsigned char* data = file.get_data();
+    long long size = file.get_size();
+    long long width = 0;
+    long long height = 0;
+    long long line_length = 0;
+
+    // The size has to be known before the grid can be filled
+    for (long long i = 0; i < size; i++) {
+        if (data[i] == '\n') {
+            width = std::max(width, line_length);
+            height++;
+            line_length = 0;
+        } else if (data[i] != '\r') {
+            line_length++;
+        }
+    }
+    if (line_length > 0) {
+        width = std::max(width, line_length);
+        height++;
+    }
+    if (!is_valid_size(width, height)) {
+        return false;
+    }
+
+    grid.reset(width, height);
+    obstacle_amount = 0;
+    int x = 0;
+    int y = height - 1;
+    for (long long i = 0; i < size; i++) {
+        if (data[i] == '\n') {
+            x = 0;
+            y--;
+        } else if (data[i] != '\r') {
+            if (data[i] == '*' || data[i] == '#') {
+                grid.set_occupied(Vector2(x, y), true);
+                obstacle_amount++;
+            }
+            x++;
+        }
+    }
+    return true;
+}
+
+// Reads a decimal number, skipping whitespace and comments before it
+bool read_pgm_number(const unsigned char* data, long long size, long long& offset, long long& value)
+{
+    while (offset < size && (std::isspace(data[offset]) || data[offset] == '#')) {
+        if (data[offset] == '#') {
+            while (offset < size && data[offset] != '\n') {
+                offset++;
+            }
+        } else {
+            offset++;
+        }
+    }
+
+    long long start = offset;
+    value = 0;
+    while (offset < size && data[offset] >= '0' && data[offset] <= '9' && value <= INT_MAX) {
+        value = value * 10 + (data[offset] - '0');
+        offset++;
+    }
+    return offset > start && value <= INT_MAX;
+}
+
+bool is_valid_size(long long width, long long height)
+{
+    return width >= 1 && height >= 1 && width <= INT_MAX && height <= INT_MAX;
+}
+
+unsigned long long read_little_endian(const unsigned char* data, int byte_amount)
+{
+    unsigned long long value = 0;
+    for (int i = 0; i < byte_amount; i++) {
+        value |= static_cast<unsigned long long>(data[i]) << (i * 8);
+    }
+    return value;
+}
+
+void append_little_endian(std::string& buffer, unsigned long long value, int byte_amount)
+{
+    for (int i = 0; i < byte_amount; i++) {
+        buffer += static_cast<char>(value >> (i * 8));
+    }
+}
+
+bool ends_with(const std::string& string, const std::string& suffix)
+{
+    return string.size() >= suffix.size() &&
+           string.compare(string.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
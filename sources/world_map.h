@@ -0,0 +1,36 @@
+// Begin header guard
+#ifndef WORLD_MAP_H
+#define WORLD_MAP_H
+
+// Includes
+#include "mapped_file.h"
+#include "occupancy_grid.h"
+#include <string>
+
+// Map files hold the obstacles of a world. Three formats are read, told apart
+// by their first bytes.
+//
+// Binary maps: the bytes "RMSM", the format version, width and height as 4
+// little endian bytes each, the amount of obstacles as 8, then the bits of an
+// occupancy grid of that size. The amount has to match the bits. Binary maps
+// are memory mapped and queried in place, so simulations sharing a map share
+// one copy of it.
+//
+// PGM images, plain (P2) or raw (P5), where pixels darker than half the
+// maximum value are obstacles.
+//
+// Text, one line per row, where '*' and '#' are obstacles and any other
+// character is free. Short lines are padded with free cells.
+//
+// Images and text are drawn the way the UIs show the grid, top row first.
+
+// Loads a map into the grid. A binary map is mapped with the file, which must
+// stay open as long as the grid is used. Returns whether the map could be
+// read.
+bool load_map(const std::string& path, MappedFile&, OccupancyGrid&, long long& obstacle_amount);
+// Saves the grid as text if the path ends in ".txt", as a raw PGM image if it
+// ends in ".pgm" and as a binary map otherwise
+bool save_map(const std::string& path, const OccupancyGrid&);
+
+// End header guard
+#endif